@@ -0,0 +1,70 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/router.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace sl::http::v1 {
+namespace {
+
+constexpr std::size_t resource_count = 500;
+
+// resource_count * 6 routes, shaped like a typical REST api
+router<std::size_t> make_router() {
+    router<std::size_t> r;
+    std::size_t value = 0;
+    for (std::size_t i = 0; i < resource_count; ++i) {
+        const std::string base = "/api/v1/resource" + std::to_string(i);
+        std::ignore = r.add(method_type::GET, base, value++);
+        std::ignore = r.add(method_type::POST, base, value++);
+        std::ignore = r.add(method_type::GET, base + "/:id", value++);
+        std::ignore = r.add(method_type::DELETE, base + "/:id", value++);
+        std::ignore = r.add(method_type::GET, base + "/:id/children/:child", value++);
+        std::ignore = r.add(method_type::GET, base + "/files/*path", value++);
+    }
+    return r;
+}
+
+void run_paths(benchmark::State& state, method_type method, const std::vector<std::string>& paths) {
+    const auto r = make_router();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto result = r.match(method, paths[i++ % paths.size()]);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+std::vector<std::string> make_paths(std::string_view suffix) {
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < resource_count; i += 7) {
+        paths.push_back("/api/v1/resource" + std::to_string(i) + std::string{ suffix });
+    }
+    return paths;
+}
+
+void BM_RouterStatic(benchmark::State& state) { run_paths(state, method_type::GET, make_paths("")); }
+void BM_RouterParam(benchmark::State& state) { run_paths(state, method_type::GET, make_paths("/12345")); }
+void BM_RouterTwoParams(benchmark::State& state) {
+    run_paths(state, method_type::GET, make_paths("/12345/children/67890"));
+}
+void BM_RouterWildcard(benchmark::State& state) {
+    run_paths(state, method_type::GET, make_paths("/files/static/css/main.css"));
+}
+void BM_RouterNotFound(benchmark::State& state) { run_paths(state, method_type::GET, make_paths("/12345/unknown")); }
+void BM_RouterMethodNotAllowed(benchmark::State& state) { run_paths(state, method_type::PUT, make_paths("/12345")); }
+
+BENCHMARK(BM_RouterStatic);
+BENCHMARK(BM_RouterParam);
+BENCHMARK(BM_RouterTwoParams);
+BENCHMARK(BM_RouterWildcard);
+BENCHMARK(BM_RouterNotFound);
+BENCHMARK(BM_RouterMethodNotAllowed);
+
+} // namespace
+} // namespace sl::http::v1
@@ -26,7 +26,7 @@ void debug_print(const http::v1::message_type& request) {
     fmt::println("=== Request # ===");
     fmt::println("{} {}", enum_to_str(req.method), http::v1::serialize(req.target));
     for (const auto& [name, value] : request.fields) {
-        fmt::println("{}: {}", name, value);
+        fmt::println("{}: {}", name.view(), value);
     }
     if (!request.body.empty()) {
         fmt::println("\n{}", http::v1::detail::buffer_byte_to_str(request.body));
@@ -49,7 +49,6 @@ http::v1::message_type handle(const http::v1::message_type& request, bool is_log
     http::v1::fields_type fields;
     fields["Content-Type"] = "text/plain";
     fields["Content-Length"] = std::to_string(body.size());
-    fields["Connection"] = "keep-alive";
 
     return http::v1::message_type{
         .fields = std::move(fields),
@@ -59,6 +58,7 @@ http::v1::message_type handle(const http::v1::message_type& request, bool is_log
                 .status = http::v1::status_type::OK,
                 .version = http::v1::version_type::HTTPv1_1,
             },
+        .framing = { .connection = request.framing.connection },
     };
 }
 
@@ -107,12 +107,17 @@ exec::async<void> client_coro(
             response,
             http::v1::serialize_config{
                 .buffer_size = BUFFER_SIZE,
+                .peer_version = std::get<http::v1::request_line_type>(maybe_request.value().start_line).version,
             }
         );
 
         std::size_t written = 0;
         while (true) {
-            const auto write_buffer = serialize(written);
+            const auto serialize_result = serialize(written);
+            if (!serialize_result.has_value()) {
+                PANIC("serialize:", serialize_result.error().message());
+            }
+            const auto write_buffer = serialize_result.value();
             if (write_buffer.empty()) {
                 break;
             }
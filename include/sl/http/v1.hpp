@@ -7,4 +7,5 @@
 #include "sl/http/v1/types.hpp"
 
 #include "sl/http/v1/deserialize.hpp"
+#include "sl/http/v1/router.hpp"
 #include "sl/http/v1/serialize.hpp"
@@ -4,5 +4,8 @@
 
 #pragma once
 
+#include "sl/http/v1/deserialize/batch.hpp"
 #include "sl/http/v1/deserialize/message.hpp"
+#include "sl/http/v1/deserialize/packed.hpp"
+#include "sl/http/v1/deserialize/query.hpp"
 #include "sl/http/v1/deserialize/target.hpp"
@@ -0,0 +1,74 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "sl/http/v1/deserialize/message.hpp"
+
+#include <sl/meta/monad/maybe.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sl::http::v1 {
+
+// One connection of a wakeup, DeserializerT is e.g. basic_deserializer<HandlerT>
+template <typename DeserializerT>
+struct deserialize_batch_item {
+    DeserializerT* deserializer;
+    std::span<const std::byte> input;
+    meta::maybe<status_type> error = meta::null; // set when the deserializer failed, the rest of input is dropped
+};
+
+// Advances the deserializers of one wakeup together: each turn handles one event of every connection that has input
+// left, while the next connection's deserializer and input are prefetched, so their cache misses overlap.
+// With every connection in cache the turns cost more than calling the deserializers one after another,
+// this pays off once their state and input miss the cache.
+// Meant to be kept around, e.g. by the event loop, its arrays are reused between wakeups.
+template <typename DeserializerT>
+class deserialize_batch {
+public:
+    // Handlers see the same events as if every deserializer was called on its own input.
+    // Returns an index into items per completed message, in the order they completed, valid until the next call.
+    std::span<const std::size_t> operator()(std::span<deserialize_batch_item<DeserializerT>> items) & {
+        active_.clear();
+        completed_.clear();
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            items[i].error = meta::null;
+            active_.push_back(i);
+        }
+
+        while (!active_.empty()) {
+            std::size_t kept = 0;
+            for (std::size_t a = 0; a < active_.size(); ++a) {
+                if (a + 1 < active_.size()) {
+                    const auto& next = items[active_[a + 1]];
+                    __builtin_prefetch(next.deserializer);
+                    __builtin_prefetch(next.input.data());
+                }
+                auto& item = items[active_[a]];
+                const auto result = item.deserializer->deserialize_some(item.input);
+                if (!result.has_value()) {
+                    item.error = result.error();
+                    continue;
+                }
+                if (result.value() == deserialize_progress::MESSAGE_COMPLETE) {
+                    completed_.push_back(active_[a]);
+                }
+                if (result.value() != deserialize_progress::INPUT_END) {
+                    active_[kept++] = active_[a];
+                }
+            }
+            active_.resize(kept);
+        }
+        return completed_;
+    }
+
+private:
+    std::vector<std::size_t> active_; // indices of items with input left, in turn order
+    std::vector<std::size_t> completed_;
+};
+
+} // namespace sl::http::v1
@@ -5,34 +5,72 @@
 #pragma once
 
 #include "sl/http/v1/detail/machine.hpp"
+#include "sl/http/v1/detail/strings.hpp"
 #include "sl/http/v1/types.hpp"
 
+#include <sl/meta/enum/from_string.hpp>
 #include <sl/meta/func/function.hpp>
+#include <sl/meta/match/overloaded.hpp>
 #include <sl/meta/monad/result.hpp>
 #include <sl/meta/type/unit.hpp>
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <span>
+#include <string>
+#include <type_traits>
 
 namespace sl::http::v1 {
 
+// Views are valid only during chunk_cb
 struct message_chunk {
     const message_type& message;
-    std::string chunk_ext;
+    std::string_view chunk_ext;
     std::span<const std::byte> chunk;
 };
 
+// What happens to the body once headers_cb accepted the message
+enum class body_mode : std::uint8_t {
+    BUFFER, // Content-Length body is collected into message_type::body, chunked body goes to chunk_cb
+    STREAM, // every piece of the body goes to chunk_cb, nothing is collected
+    DISCARD, // body is read and dropped
+};
+
+// Callbacks are only used when deserializing into message_type, limits apply to every handler
 struct deserialize_config {
     meta::unique_function<void(message_chunk)> chunk_cb = [](message_chunk) {};
     meta::unique_function<void(message_type)> message_cb = [](message_type) {};
+    // Called once the field section is parsed, before any body is read.
+    // Accepts the message by choosing a body_mode, or rejects it with a final status.
+    meta::unique_function<meta::result<body_mode, status_type>(const message_type&)> headers_cb =
+        [](const message_type&) -> meta::result<body_mode, status_type> { return body_mode::BUFFER; };
+    // Called once the fields of a request with "Expect: 100-continue" and a body are parsed, before any body is read.
+    // Return null to proceed, after sending serialize_continue(), or a final status to reject with, e.g. 413 or 417.
+    meta::unique_function<meta::maybe<status_type>(const message_type&)> expect_cb =
+        [](const message_type&) -> meta::maybe<status_type> { return meta::null; };
+    // Only these fields and trailers are stored in message_type::fields, null retains every field.
+    // Framing fields are always retained, the rest is still validated and counted toward max_field_size.
+    meta::maybe<field_names_type> retained_fields{};
 
     std::size_t max_body_size = 1 * 1024 * 1024; // 1 MiB default
     std::size_t max_field_size = 80 * 1024; // 80 KiB default
+    std::size_t max_field_count = 100; // per field section, trailers are counted separately
     std::size_t max_reason_size = 8000; // recommended as per RFC 9112
     std::size_t max_target_size = 8000; // recommended as per RFC 9112
     std::size_t max_chunk_size_size = 8;
     std::size_t max_chunk_line_size = max_chunk_size_size + 8 * 1024; // 8B + 8KiB
+    // Consecutive chunks without extensions from one input are merged into a single chunk_cb call
+    // of up to this size, 0 delivers every chunk on its own
+    std::size_t coalesced_chunk_size = 0;
+    // A buffered body growing past this size is moved to an unlinked file in body_spill_directory and continues
+    // there, message_type::body_file is set instead of message_type::body. Failing to spill is 500.
+    // Only body_mode::BUFFER with Content-Length collects a body, STREAM, DISCARD and chunked bodies never spill.
+    std::size_t body_spill_size = std::numeric_limits<std::size_t>::max();
+    std::string body_spill_directory = "/tmp";
 };
 
 meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
@@ -41,60 +79,221 @@ meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)
 meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
     make_deserialize_response(deserialize_config config);
 
+struct parse_ok {
+    message_type message;
+    std::size_t offset; // bytes consumed, whatever follows belongs to the next message
+};
+
+// One pass over a buffer that already holds a complete message: no callbacks, no buffering, no machine.
+// Only limits and retained_fields of config are used, chunked body is joined into message_type::body.
+// Input that ends before the message does is BAD_REQUEST.
+meta::result<parse_ok, status_type> parse_request(std::span<const std::byte> input);
+meta::result<parse_ok, status_type> parse_request(std::span<const std::byte> input, const deserialize_config& config);
+
+meta::result<parse_ok, status_type> parse_response(std::span<const std::byte> input);
+meta::result<parse_ok, status_type> parse_response(std::span<const std::byte> input, const deserialize_config& config);
+
+// what one call of deserialize_some did
+enum class deserialize_progress : std::uint8_t {
+    EVENT, // handled an event, call again
+    MESSAGE_COMPLETE, // handled the end of a message, call again
+    INPUT_END, // input is consumed or buffered and on_input_end was handled
+};
+
+// Features and limits of the deserializer decided at compile time, derive and hide a member to change one.
+// The core is instantiated per policy: states of disabled features are compiled out and a feature is rejected
+// where it is first seen in the input.
+// A limit of deserialize_config the policy declares as a static constexpr member, e.g. max_field_size,
+// is a constant and the config's value is ignored.
+struct deserialize_policy {
+    static constexpr bool is_chunked_allowed = true; // otherwise Transfer-Encoding is NOT_IMPLEMENTED
+    static constexpr bool is_trailers_allowed = true; // otherwise trailer fields are BAD_REQUEST
+    static constexpr bool is_absolute_form_allowed = true; // absolute-form and authority-form targets
+    static constexpr bool is_http_1_0_allowed = true; // otherwise HTTP/1.0 is HTTP_VERSION_NOT_SUPPORTED
+};
+
+// Origin-form HTTP/1.1 with Content-Length only, e.g. between internal services
+// Head limits are the config defaults as constants, max_body_size still comes from the config
+struct minimal_deserialize_policy : deserialize_policy {
+    static constexpr bool is_chunked_allowed = false;
+    static constexpr bool is_trailers_allowed = false;
+    static constexpr bool is_absolute_form_allowed = false;
+    static constexpr bool is_http_1_0_allowed = false;
+
+    static constexpr std::size_t max_target_size = 8000;
+    static constexpr std::size_t max_field_size = 80 * 1024;
+    static constexpr std::size_t max_field_count = 100;
+};
+
 namespace detail {
 
+enum class deserialize_state_kind : std::uint8_t {
+    REQUEST_METHOD,
+    REQUEST_TARGET,
+    REQUEST_VERSION,
+    RESPONSE_VERSION,
+    RESPONSE_STATUS,
+    RESPONSE_REASON,
+    FIELDS,
+    EXPECT,
+    BODY,
+    CHUNKED_BODY_EMPTY,
+    CHUNKED_BODY_LINE,
+    TRAILING_FIELDS,
+    COMPLETE,
+};
+
+// Typed states, taken by the per-state functions of deserialize_core
 struct deserialize_state_start_line_request_method {};
 struct deserialize_state_start_line_request_target {};
 struct deserialize_state_start_line_request_version {};
-using deserialize_state_start_line_request = std::variant< //
-    deserialize_state_start_line_request_method,
-    deserialize_state_start_line_request_target,
-    deserialize_state_start_line_request_version>;
 
 struct deserialize_state_start_line_response_version {};
 struct deserialize_state_start_line_response_status {};
 struct deserialize_state_start_line_response_reason {};
-using deserialize_state_start_line_response = std::variant< //
-    deserialize_state_start_line_response_version,
-    deserialize_state_start_line_response_status,
-    deserialize_state_start_line_response_reason>;
-
-using deserialize_state_start_line =
-    std::variant<deserialize_state_start_line_request, deserialize_state_start_line_response>;
 
 struct deserialize_state_fields {
     std::size_t consumed_bytes = 0;
+    std::size_t field_count = 0;
 };
 struct deserialize_state_body {
-    std::size_t content_length = 0;
+    std::size_t content_length_left = 0;
 };
 
 struct deserialize_state_chunked_body_empty {};
 struct deserialize_state_chunked_body_line {
-    std::string chunk_ext;
-    std::uint32_t chunk_size = 0;
+    std::uint32_t chunk_size = 0; // 0 is the last-chunk
 };
-struct deserialize_state_chunked_body_complete {
-    std::string chunk_ext;
-    std::span<const std::byte> chunk;
+
+// paused between fields and body until the handler decides on the expectation
+struct deserialize_state_expect {
+    std::size_t content_length_left = 0; // when not chunked
+    bool is_chunked = false;
 };
-using deserialize_state_chunked_body = std::variant< //
-    deserialize_state_chunked_body_empty,
-    deserialize_state_chunked_body_line,
-    deserialize_state_chunked_body_complete>;
 
 struct deserialize_state_trailing_fields {
     std::size_t consumed_bytes = 0;
+    std::size_t field_count = 0;
 };
 struct deserialize_state_complete {};
 
-using deserialize_state = std::variant< //
-    deserialize_state_start_line,
-    deserialize_state_fields,
-    deserialize_state_body,
-    deserialize_state_chunked_body,
-    deserialize_state_trailing_fields,
-    deserialize_state_complete>;
+// Flat state: a kind plus a payload shared by every kind, dispatched with a single switch
+// Converts from any typed state and back with as<StateT>()
+class deserialize_state {
+public:
+    deserialize_state(deserialize_state_start_line_request_method) : kind_{ deserialize_state_kind::REQUEST_METHOD } {}
+    deserialize_state(deserialize_state_start_line_request_target) : kind_{ deserialize_state_kind::REQUEST_TARGET } {}
+    deserialize_state(deserialize_state_start_line_request_version)
+        : kind_{ deserialize_state_kind::REQUEST_VERSION } {}
+    deserialize_state(deserialize_state_start_line_response_version)
+        : kind_{ deserialize_state_kind::RESPONSE_VERSION } {}
+    deserialize_state(deserialize_state_start_line_response_status)
+        : kind_{ deserialize_state_kind::RESPONSE_STATUS } {}
+    deserialize_state(deserialize_state_start_line_response_reason)
+        : kind_{ deserialize_state_kind::RESPONSE_REASON } {}
+    deserialize_state(deserialize_state_fields s)
+        : kind_{ deserialize_state_kind::FIELDS }, size_{ s.consumed_bytes }, count_{ s.field_count } {}
+    deserialize_state(deserialize_state_expect s)
+        : kind_{ deserialize_state_kind::EXPECT }, is_chunked_{ s.is_chunked }, size_{ s.content_length_left } {}
+    deserialize_state(deserialize_state_body s)
+        : kind_{ deserialize_state_kind::BODY }, size_{ s.content_length_left } {}
+    deserialize_state(deserialize_state_chunked_body_empty) : kind_{ deserialize_state_kind::CHUNKED_BODY_EMPTY } {}
+    deserialize_state(deserialize_state_chunked_body_line s)
+        : kind_{ deserialize_state_kind::CHUNKED_BODY_LINE }, size_{ s.chunk_size } {}
+    deserialize_state(deserialize_state_trailing_fields s)
+        : kind_{ deserialize_state_kind::TRAILING_FIELDS }, size_{ s.consumed_bytes }, count_{ s.field_count } {}
+    deserialize_state(deserialize_state_complete) : kind_{ deserialize_state_kind::COMPLETE } {}
+
+    deserialize_state_kind kind() const { return kind_; }
+
+    template <typename StateT>
+    bool is() const {
+        return kind_ == deserialize_state{ StateT{} }.kind_;
+    }
+
+    template <typename StateT>
+    StateT as() const {
+        DEBUG_ASSERT(is<StateT>());
+        if constexpr (std::is_same_v<StateT, deserialize_state_fields>
+                      || std::is_same_v<StateT, deserialize_state_trailing_fields>) {
+            return StateT{ .consumed_bytes = size_, .field_count = count_ };
+        } else if constexpr (std::is_same_v<StateT, deserialize_state_expect>) {
+            return StateT{ .content_length_left = size_, .is_chunked = is_chunked_ };
+        } else if constexpr (std::is_same_v<StateT, deserialize_state_body>) {
+            return StateT{ .content_length_left = size_ };
+        } else if constexpr (std::is_same_v<StateT, deserialize_state_chunked_body_line>) {
+            return StateT{ .chunk_size = static_cast<std::uint32_t>(size_) };
+        } else {
+            return StateT{};
+        }
+    }
+
+private:
+    deserialize_state_kind kind_;
+    bool is_chunked_ = false;
+    std::size_t size_ = 0; // consumed bytes, content length left or chunk size
+    std::size_t count_ = 0; // field count
+};
+
+// Views point into the input and are valid only while the event is handled
+struct deserialize_event_none {};
+struct deserialize_event_method {
+    method_type method;
+};
+struct deserialize_event_target {
+    std::string_view target; // raw request-target
+};
+struct deserialize_event_version {
+    version_type version;
+};
+struct deserialize_event_status {
+    status_type status;
+};
+struct deserialize_event_reason {
+    std::string_view reason;
+};
+struct deserialize_event_field {
+    std::string_view name; // as received, not lowercased
+    std::string_view lowercase_name; // folded while scanning, empty if name is longer than the buffer for it
+    std::string_view value; // without surrounding OWS
+};
+struct deserialize_event_headers {}; // field section is over, framing is decoded
+struct deserialize_event_expect {}; // "Expect: 100-continue" with a body, none of it is read yet
+struct deserialize_event_chunk_ext {
+    std::string_view chunk_ext;
+};
+struct deserialize_event_body {
+    std::span<const std::byte> body; // empty only for the last-chunk
+};
+struct deserialize_event_trailer {
+    std::string_view name;
+    std::string_view lowercase_name;
+    std::string_view value;
+};
+struct deserialize_event_complete {};
+
+using deserialize_event = std::variant< //
+    deserialize_event_none,
+    deserialize_event_method,
+    deserialize_event_target,
+    deserialize_event_version,
+    deserialize_event_status,
+    deserialize_event_reason,
+    deserialize_event_field,
+    deserialize_event_headers,
+    deserialize_event_expect,
+    deserialize_event_chunk_ext,
+    deserialize_event_body,
+    deserialize_event_trailer,
+    deserialize_event_complete>;
+
+// What the core itself needs to remember about the current message
+struct deserialize_context {
+    framing_type framing{};
+    version_type version = version_type::ENUM_END;
+    bool is_request = true;
+    std::array<char, 64> lowercase_field_name{}; // lowercase_name of field and trailer events points here
+};
 
 struct deserialize_ok {
     // continue is offset > 0 or offset == continue_token
@@ -109,149 +308,1079 @@ struct deserialize_ok {
 public:
     deserialize_state state;
     std::size_t offset;
+    deserialize_event event{};
 };
 
-struct deserialize_machine {
-    constexpr deserialize_machine(deserialize_config config, bool is_request) : config_{ std::move(config) } {
-        DEBUG_ASSERT(!!config_.message_cb);
-        if (is_request) {
-            output_.start_line = request_line_type{};
-            state_ = deserialize_state_start_line{ deserialize_state_start_line_request{} };
+// Limits of PolicyT, falling back to the config for the ones it doesn't declare
+template <typename PolicyT>
+struct deserialize_limits {
+    static std::size_t max_body_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_body_size; }) {
+            return PolicyT::max_body_size;
+        } else {
+            return config.max_body_size;
+        }
+    }
+    static std::size_t max_field_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_field_size; }) {
+            return PolicyT::max_field_size;
+        } else {
+            return config.max_field_size;
+        }
+    }
+    static std::size_t max_field_count(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_field_count; }) {
+            return PolicyT::max_field_count;
+        } else {
+            return config.max_field_count;
+        }
+    }
+    static std::size_t max_reason_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_reason_size; }) {
+            return PolicyT::max_reason_size;
+        } else {
+            return config.max_reason_size;
+        }
+    }
+    static std::size_t max_target_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_target_size; }) {
+            return PolicyT::max_target_size;
+        } else {
+            return config.max_target_size;
+        }
+    }
+    static std::size_t max_chunk_size_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_chunk_size_size; }) {
+            return PolicyT::max_chunk_size_size;
+        } else {
+            return config.max_chunk_size_size;
+        }
+    }
+    static std::size_t max_chunk_line_size(const deserialize_config& config) {
+        if constexpr (requires { PolicyT::max_chunk_line_size; }) {
+            return PolicyT::max_chunk_line_size;
         } else {
-            output_.start_line = response_line_type{};
-            state_ = deserialize_state_start_line{ deserialize_state_start_line_response{} };
+            return config.max_chunk_line_size;
         }
     }
+};
 
-    meta::maybe<status_type> deserialize(std::span<const std::byte> input) &;
+// Decodes framing fields while their line is at hand, so finalize doesn't have to look them up
+// Returns error on invalid, duplicate or conflicting framing
+meta::maybe<status_type>
+    deserialize_framing_field(framing_type& framing, std::string_view field_key, std::string_view field_value);
 
-private: // only dispatch and mutation
-    meta::result<std::size_t, status_type> deserialize_impl(std::span<const std::byte> input) &;
+// State transitions, limits and framing shared by every handler, instantiated per policy
+// Each step consumes `offset` bytes and emits at most one event, which only views the input
+template <typename PolicyT>
+struct basic_deserialize_core {
+    using limits = deserialize_limits<PolicyT>;
 
-public: // transparent
-    static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_start_line state,
-        const deserialize_config& config,
-        std::span<const std::byte> input
-    );
+    static deserialize_state initial_state(bool is_request);
 
-    static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_start_line_request state,
+    // dispatches to the function of the current state
+    static meta::result<deserialize_ok, status_type> deserialize_step(
+        deserialize_context& context,
+        const deserialize_state& state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
+
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_request_method state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_request_target state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_request_version state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
 
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_start_line_response state,
-        const deserialize_config& config,
-        std::span<const std::byte> input
-    );
-    static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_response_version state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_response_status state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_start_line_response_reason state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
 
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_fields state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_trailing_fields state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
-    static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        std::variant<deserialize_state_fields, deserialize_state_trailing_fields> state,
+    // shared by fields and trailing fields
+    template <typename FieldsStateT>
+    static meta::result<deserialize_ok, status_type> deserialize_field_line(
+        deserialize_context& context,
+        FieldsStateT state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_state, status_type>
-        deserialize_state_fields_finalize(message_type& output, const deserialize_config& config);
+        deserialize_state_fields_finalize(deserialize_context& context, const deserialize_config& config);
+    // HTTP-version of either start line, checked against the policy
+    static meta::result<version_type, status_type> deserialize_version(std::string_view version_str);
 
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_body state,
+        deserialize_context& context,
+        deserialize_state_expect state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
 
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_chunked_body state,
+        deserialize_context& context,
+        deserialize_state_body state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
+
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_chunked_body_empty state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_chunked_body_line state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
-    static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
-        deserialize_state_chunked_body_complete state,
-        const deserialize_config& config,
-        std::span<const std::byte> input
-    );
 
     static meta::result<deserialize_ok, status_type> deserialize_impl(
-        message_type& output,
+        deserialize_context& context,
         deserialize_state_complete state,
         const deserialize_config& config,
         std::span<const std::byte> input
     );
+};
+
+using deserialize_core = basic_deserialize_core<deserialize_policy>;
+
+template <typename PolicyT>
+deserialize_state basic_deserialize_core<PolicyT>::initial_state(bool is_request) {
+    if (is_request) {
+        return deserialize_state_start_line_request_method{};
+    }
+    return deserialize_state_start_line_response_version{};
+}
+
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_step(
+    deserialize_context& context,
+    const deserialize_state& state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    using enum deserialize_state_kind;
+    switch (state.kind()) {
+    case REQUEST_METHOD:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_request_method>(), config, input);
+    case REQUEST_TARGET:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_request_target>(), config, input);
+    case REQUEST_VERSION:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_request_version>(), config, input);
+    case RESPONSE_VERSION:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_response_version>(), config, input);
+    case RESPONSE_STATUS:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_response_status>(), config, input);
+    case RESPONSE_REASON:
+        return deserialize_impl(context, state.as<deserialize_state_start_line_response_reason>(), config, input);
+    case FIELDS:
+        return deserialize_impl(context, state.as<deserialize_state_fields>(), config, input);
+    case EXPECT:
+        return deserialize_impl(context, state.as<deserialize_state_expect>(), config, input);
+    case BODY:
+        return deserialize_impl(context, state.as<deserialize_state_body>(), config, input);
+    case CHUNKED_BODY_EMPTY:
+        if constexpr (PolicyT::is_chunked_allowed) {
+            return deserialize_impl(context, state.as<deserialize_state_chunked_body_empty>(), config, input);
+        }
+        break;
+    case CHUNKED_BODY_LINE:
+        if constexpr (PolicyT::is_chunked_allowed) {
+            return deserialize_impl(context, state.as<deserialize_state_chunked_body_line>(), config, input);
+        }
+        break;
+    case TRAILING_FIELDS:
+        if constexpr (PolicyT::is_chunked_allowed) {
+            return deserialize_impl(context, state.as<deserialize_state_trailing_fields>(), config, input);
+        }
+        break;
+    case COMPLETE:
+        return deserialize_impl(context, state.as<deserialize_state_complete>(), config, input);
+    }
+    std::unreachable(); // chunked states are never entered without chunked framing
+}
+
+// method SP request-target SP HTTP-version CRLF
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_request_method state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    constexpr std::size_t method_max_length = enum_max_str_length<method_type>();
+
+    const auto method_result = try_find(input_str, tokens::SP, method_max_length);
+    if (!method_result.has_value()) {
+        const auto& method_err = method_result.error();
+        if (method_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::NOT_IMPLEMENTED);
+        }
+        DEBUG_ASSERT(method_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+
+    const auto& [method_str, method_offset] = method_result.value();
+    const auto method = meta::enum_from_str<method_type>(method_str);
+    if (method == method_type::ENUM_END) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+
+    return deserialize_ok{
+        .state = deserialize_state_start_line_request_target{},
+        .offset = method_offset,
+        .event = deserialize_event_method{ method },
+    };
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_request_target state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    const auto target_result = try_find(input_str, tokens::SP, limits::max_target_size(config));
+    if (!target_result.has_value()) {
+        const auto& target_err = target_result.error();
+        if (target_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::URI_TOO_LONG);
+        }
+        DEBUG_ASSERT(target_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+    const auto& [target_str, target_offset] = target_result.value();
+    if constexpr (!PolicyT::is_absolute_form_allowed) {
+        if (!target_str.starts_with('/') && target_str != "*") {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+    }
+    return deserialize_ok{
+        .state = deserialize_state_start_line_request_version{},
+        .offset = target_offset,
+        .event = deserialize_event_target{ target_str },
+    };
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_request_version state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    constexpr std::size_t version_max_length = enum_max_str_length<version_type>();
+    const auto version_result = try_find(input_str, tokens::CRLF, version_max_length);
+    if (!version_result.has_value()) {
+        const auto& version_err = version_result.error();
+        if (version_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(version_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+
+    const auto& [version_str, version_offset] = version_result.value();
+    const auto version_parse_result = deserialize_version(version_str);
+    if (!version_parse_result.has_value()) {
+        return meta::err(version_parse_result.error());
+    }
+    const version_type version = version_parse_result.value();
+
+    context.version = version;
+    return deserialize_ok{
+        .state = deserialize_state_fields{},
+        .offset = version_offset,
+        .event = deserialize_event_version{ version },
+    };
+}
+
+// HTTP-version SP status-code SP [ reason-phrase ] CRLF
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_response_version state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    constexpr std::size_t version_max_length = enum_max_str_length<version_type>();
+    const auto version_result = try_find(input_str, tokens::SP, version_max_length);
+    if (!version_result.has_value()) {
+        const auto& version_err = version_result.error();
+        if (version_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(version_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+
+    const auto& [version_str, version_offset] = version_result.value();
+    const auto version_parse_result = deserialize_version(version_str);
+    if (!version_parse_result.has_value()) {
+        return meta::err(version_parse_result.error());
+    }
+    const version_type version = version_parse_result.value();
+
+    context.version = version;
+    return deserialize_ok{
+        .state = deserialize_state_start_line_response_status{},
+        .offset = version_offset,
+        .event = deserialize_event_version{ version },
+    };
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_response_status state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    constexpr std::size_t status_code_length = 3;
+
+    const auto status_result = try_find(input_str, tokens::SP, status_code_length);
+    if (!status_result.has_value()) {
+        const auto& status_err = status_result.error();
+        if (status_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(status_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+
+    const auto& [status_str, status_offset] = status_result.value();
+    if (status_str.size() != status_code_length) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+
+    std::uint16_t status_code = 0;
+    const auto conv_result = std::from_chars(status_str.begin(), status_str.end(), status_code);
+    if (conv_result.ec != std::error_code{} || conv_result.ptr != status_str.end()) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+
+    return deserialize_ok{
+        .state = deserialize_state_start_line_response_reason{},
+        .offset = status_offset,
+        .event = deserialize_event_status{ static_cast<status_type>(status_code) },
+    };
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_start_line_response_reason state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    const auto reason_result = try_find(input_str, tokens::CRLF, limits::max_reason_size(config));
+    if (!reason_result.has_value()) {
+        const auto& reason_err = reason_result.error();
+        if (reason_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(reason_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+
+    const auto& [reason_str, reason_offset] = reason_result.value();
+    return deserialize_ok{
+        .state = deserialize_state_fields{},
+        .offset = reason_offset,
+        .event = deserialize_event_reason{ reason_str },
+    };
+}
+
+// *( field-line CRLF ) CRLF
+// field-line   = field-name ":" OWS field-value OWS
+// OWS = *(SP / HTAB)
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_fields state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    return deserialize_field_line(context, state, config, input);
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_trailing_fields state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    return deserialize_field_line(context, state, config, input);
+}
+template <typename PolicyT>
+template <typename FieldsStateT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_field_line(
+    deserialize_context& context,
+    FieldsStateT state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    const auto field_line_result =
+        scan_field_line(input_str, limits::max_field_size(config) - state.consumed_bytes, context.lowercase_field_name);
+    if (!field_line_result.has_value()) {
+        const auto& scan_err = field_line_result.error();
+        if (scan_err == field_line_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::CONTENT_TOO_LARGE);
+        }
+        if (scan_err == field_line_err::MALFORMED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(scan_err == field_line_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+    const auto& [field_key, lowercase_field_key, field_value, field_line_offset] = field_line_result.value();
+    state.consumed_bytes += field_line_offset;
+    constexpr bool is_trailer = std::is_same_v<FieldsStateT, deserialize_state_trailing_fields>;
+
+    if (!field_key.empty()) {
+        if (++state.field_count > limits::max_field_count(config)) {
+            return meta::err(status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+        }
+
+        if constexpr (is_trailer && !PolicyT::is_trailers_allowed) {
+            return meta::err(status_type::BAD_REQUEST);
+        } else if constexpr (is_trailer) { // framing is not taken from trailers
+            return deserialize_ok{
+                .state = state,
+                .offset = field_line_offset,
+                .event =
+                    deserialize_event_trailer{
+                        .name = field_key,
+                        .lowercase_name = lowercase_field_key,
+                        .value = field_value,
+                    },
+            };
+        } else {
+            if (const auto maybe_error = deserialize_framing_field(context.framing, field_key, field_value);
+                maybe_error.has_value()) {
+                return meta::err(maybe_error.value());
+            }
+            if constexpr (!PolicyT::is_chunked_allowed) {
+                if (context.framing.has_transfer_encoding) {
+                    return meta::err(status_type::NOT_IMPLEMENTED);
+                }
+            }
+            return deserialize_ok{
+                .state = state,
+                .offset = field_line_offset,
+                .event =
+                    deserialize_event_field{
+                        .name = field_key,
+                        .lowercase_name = lowercase_field_key,
+                        .value = field_value,
+                    },
+            };
+        }
+    }
+
+    // detected last CRLF
+
+    if constexpr (is_trailer) {
+        return deserialize_ok{ .state = deserialize_state_complete{}, .offset = field_line_offset };
+    } else {
+        return deserialize_state_fields_finalize(context, config).map([field_line_offset](deserialize_state s) {
+            return deserialize_ok{
+                .state = s,
+                .offset = field_line_offset,
+                .event = deserialize_event_headers{},
+            };
+        });
+    }
+}
+
+template <typename PolicyT>
+meta::result<version_type, status_type>
+    basic_deserialize_core<PolicyT>::deserialize_version(std::string_view version_str) {
+    if constexpr (!PolicyT::is_http_1_0_allowed) {
+        if (version_str == enum_to_str(version_type::HTTPv1_1)) { // the only one left, no lookup
+            return version_type::HTTPv1_1;
+        }
+    }
+    const auto version = meta::enum_from_str<version_type>(version_str);
+    if (version == version_type::ENUM_END) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+    if constexpr (!PolicyT::is_http_1_0_allowed) {
+        return meta::err(status_type::HTTP_VERSION_NOT_SUPPORTED);
+    } else {
+        return version;
+    }
+}
+
+template <typename PolicyT>
+meta::result<deserialize_state, status_type> basic_deserialize_core<PolicyT>::deserialize_state_fields_finalize(
+    deserialize_context& context,
+    const deserialize_config& config
+) {
+    auto& framing = context.framing;
+    framing.connection = connection_verdict(framing, context.version);
+
+    // Expect is only meaningful with a body, RFC 9110 10.1.1
+    // and a 100-continue from an HTTP/1.0 client is ignored, it may not understand an interim response
+    if (framing.expect == expect_type::CONTINUE && context.version != version_type::HTTPv1_1) {
+        framing.expect = expect_type::NONE;
+    }
+    const bool is_request = context.is_request;
+    const auto expect_or = [&framing, is_request](deserialize_state body_state,
+                                                  deserialize_state_expect expect_state
+                               ) -> meta::result<deserialize_state, status_type> {
+        if (!is_request || framing.expect == expect_type::NONE) {
+            return body_state;
+        }
+        if (framing.expect == expect_type::UNKNOWN) {
+            return meta::err(status_type::EXPECTATION_FAILED);
+        }
+        return deserialize_state{ expect_state };
+    };
+
+    if constexpr (PolicyT::is_chunked_allowed) { // otherwise rejected as soon as Transfer-Encoding is seen
+        if (framing.is_chunked) {
+            return expect_or(deserialize_state_chunked_body_empty{}, deserialize_state_expect{ .is_chunked = true });
+        }
+        if (framing.has_transfer_encoding) {
+            // length can't be determined, RFC 9112 6.3
+            return meta::err(status_type::BAD_REQUEST);
+        }
+    }
+
+    const auto content_length = framing.content_length.value_or(0);
+    if (content_length == 0) {
+        return deserialize_state_complete{};
+    }
+
+    if (content_length > limits::max_body_size(config)) {
+        return meta::err(status_type::CONTENT_TOO_LARGE);
+    }
+
+    return expect_or(
+        deserialize_state_body{ .content_length_left = content_length },
+        deserialize_state_expect{ .content_length_left = content_length }
+    );
+}
+
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_expect state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    return deserialize_ok{
+        .state = state.is_chunked
+                     ? deserialize_state{ deserialize_state_chunked_body_empty{} }
+                     : deserialize_state{ deserialize_state_body{ .content_length_left = state.content_length_left } },
+        .offset = deserialize_ok::continue_token,
+        .event = deserialize_event_expect{},
+    };
+}
+
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_body state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    if (state.content_length_left == 0) {
+        return deserialize_ok{ .state = deserialize_state_complete{}, .offset = deserialize_ok::continue_token };
+    }
+
+    if (input.empty()) {
+        return deserialize_ok::stop(state);
+    }
+
+    const std::size_t chunk_size = std::min(state.content_length_left, input.size());
+    return deserialize_ok{
+        .state = deserialize_state_body{ .content_length_left = state.content_length_left - chunk_size },
+        .offset = chunk_size,
+        .event = deserialize_event_body{ input.subspan(0, chunk_size) },
+    };
+}
+
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_chunked_body_empty state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const auto input_str = buffer_byte_to_str(input);
+    const auto chunk_line_result = try_find(input_str, tokens::CRLF, limits::max_chunk_line_size(config));
+    if (!chunk_line_result.has_value()) {
+        const auto chunk_line_err = chunk_line_result.error();
+        if (chunk_line_err == find_err::MAX_SIZE_EXCEEDED) {
+            return meta::err(status_type::BAD_REQUEST);
+        }
+        DEBUG_ASSERT(chunk_line_err == find_err::NOT_FOUND);
+        return deserialize_ok::stop(state);
+    }
+    const auto& chunk_line_ok = chunk_line_result.value();
+
+    const auto split_result = try_find_split_unlimited(chunk_line_ok.value, ";");
+
+    const auto chunk_size_str = strip_suffix_while(split_result.head, tokens::is_ws); // BWS
+    if (chunk_size_str.size() > limits::max_chunk_size_size(config)) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+    const auto maybe_chunk_size = [chunk_size_str]() -> meta::maybe<std::uint32_t> {
+        std::uint32_t chunk_size = 0;
+        const auto conv_result = std::from_chars(chunk_size_str.begin(), chunk_size_str.end(), chunk_size, 16);
+        if (conv_result.ec != std::error_code{} || conv_result.ptr != chunk_size_str.end()) {
+            return meta::null;
+        }
+        return chunk_size;
+    }();
+    if (!maybe_chunk_size.has_value()) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+    const std::uint32_t chunk_size = maybe_chunk_size.value();
+
+    const auto chunk_ext = split_result //
+                               .tail
+                               .map([](std::string_view x) { return strip_prefix_while(x, tokens::is_ws); }) // BWS
+                               .value_or(std::string_view{});
+
+    return deserialize_ok{
+        .state = deserialize_state_chunked_body_line{ .chunk_size = chunk_size },
+        .offset = chunk_line_ok.offset,
+        .event = deserialize_event_chunk_ext{ chunk_ext },
+    };
+}
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_chunked_body_line state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const std::uint32_t chunk_size = state.chunk_size;
+    if (chunk_size == 0) { // last-chunk
+        return deserialize_ok{
+            .state = deserialize_state_trailing_fields{},
+            .offset = deserialize_ok::continue_token,
+            .event = deserialize_event_body{},
+        };
+    }
+
+    const std::size_t offset = chunk_size + tokens::CRLF.size();
+    if (input.size() < offset) {
+        return deserialize_ok::stop(state);
+    }
+
+    if (const std::string_view crlf_expected = buffer_byte_to_str(input.subspan(chunk_size, tokens::CRLF.size()));
+        crlf_expected != tokens::CRLF) {
+        return meta::err(status_type::BAD_REQUEST);
+    }
+
+    return deserialize_ok{
+        .state = deserialize_state_chunked_body_empty{},
+        .offset = offset,
+        .event = deserialize_event_body{ input.subspan(0, chunk_size) },
+    };
+}
+
+template <typename PolicyT>
+meta::result<deserialize_ok, status_type> basic_deserialize_core<PolicyT>::deserialize_impl(
+    deserialize_context& context,
+    deserialize_state_complete state,
+    const deserialize_config& config,
+    std::span<const std::byte> input
+) {
+    const bool is_request = context.is_request;
+    context = deserialize_context{ .is_request = is_request };
+    return deserialize_ok{
+        .state = initial_state(is_request),
+        .offset = deserialize_ok::continue_token,
+        .event = deserialize_event_complete{},
+    };
+}
+
+// Hooks return void or meta::maybe<status_type>, a status stops deserialization with it
+template <typename F>
+meta::maybe<status_type> invoke_deserialize_hook(F&& f) {
+    if constexpr (std::is_void_v<std::invoke_result_t<F>>) {
+        std::forward<F>(f)();
+        return meta::null;
+    } else {
+        return std::forward<F>(f)();
+    }
+}
+
+// Drives basic_deserialize_core<PolicyT> and hands its events over to HandlerT, every hook is optional:
+//   on_method(method_type), on_target(std::string_view), on_version(version_type),
+//   on_status(status_type), on_reason(std::string_view),
+//   on_field(std::string_view name, std::string_view value), on_headers(const framing_type&), on_expect(),
+//   on_chunk_ext(std::string_view), on_body(std::span<const std::byte>),
+//   on_trailer(std::string_view name, std::string_view value), on_complete(),
+//   on_field/on_trailer may take the whole event instead, to get the lowercase name as well
+//   on_input_end() once deserialize consumed its input
+// ConfigT either owns the config or is std::reference_wrapper<const deserialize_config> to share one
+template <typename HandlerT, typename ConfigT = deserialize_config, typename PolicyT = deserialize_policy>
+struct basic_deserialize_machine {
+    using core = basic_deserialize_core<PolicyT>;
+
+    basic_deserialize_machine(HandlerT handler, ConfigT config, bool is_request)
+        : handler_{ std::move(handler) }, context_{ .is_request = is_request },
+          state_{ core::initial_state(is_request) }, config_{ std::move(config) } {}
+
+    meta::maybe<status_type> deserialize(std::span<const std::byte> input) & {
+        if (remainder_.view().empty()) { // less allocations and copying
+            while (!input.empty()) {
+                const auto result = deserialize_impl(input);
+                if (!result.has_value()) {
+                    return result.error();
+                }
+                const std::size_t offset = result.value().offset;
+                if (offset == deserialize_ok::continue_token) {
+                    continue;
+                }
+                input = input.subspan(offset);
+                if (offset == 0) {
+                    break;
+                }
+            }
+        }
+
+        std::ignore = remainder_.merge(input);
+
+        while (true) {
+            const auto result = deserialize_impl(remainder_.view());
+            if (!result.has_value()) {
+                return result.error();
+            }
+            const std::size_t offset = result.value().offset;
+            if (offset == deserialize_ok::continue_token) {
+                continue;
+            }
+            remainder_.add_offset(offset);
+            if (offset == 0) {
+                break;
+            }
+        }
+
+        if constexpr (requires { handler_.on_input_end(); }) {
+            return invoke_deserialize_hook([&] { return handler_.on_input_end(); });
+        }
+        return meta::null;
+    }
+
+    // At most one event per call, for callers interleaving several machines. input is advanced past what was
+    // consumed or buffered, calling this until INPUT_END handles the same events as deserialize(input).
+    meta::result<deserialize_progress, status_type> deserialize_some(std::span<const std::byte>& input) & {
+        if (remainder_.view().empty() && !input.empty()) {
+            const auto result = deserialize_impl(input);
+            if (!result.has_value()) {
+                return meta::err(result.error());
+            }
+            const auto [offset, is_complete] = result.value();
+            if (offset != 0) {
+                if (offset != deserialize_ok::continue_token) {
+                    input = input.subspan(offset);
+                }
+                return is_complete ? deserialize_progress::MESSAGE_COMPLETE : deserialize_progress::EVENT;
+            }
+        }
+
+        if (!input.empty()) {
+            std::ignore = remainder_.merge(input);
+            input = {};
+        }
+
+        const auto result = deserialize_impl(remainder_.view());
+        if (!result.has_value()) {
+            return meta::err(result.error());
+        }
+        const auto [offset, is_complete] = result.value();
+        if (offset != 0) {
+            if (offset != deserialize_ok::continue_token) {
+                remainder_.add_offset(offset);
+            }
+            return is_complete ? deserialize_progress::MESSAGE_COMPLETE : deserialize_progress::EVENT;
+        }
+
+        if constexpr (requires { handler_.on_input_end(); }) {
+            if (const auto maybe_error = invoke_deserialize_hook([&] { return handler_.on_input_end(); });
+                maybe_error.has_value()) {
+                return meta::err(maybe_error.value());
+            }
+        }
+        return deserialize_progress::INPUT_END;
+    }
+
+    HandlerT& handler() & { return handler_; }
+    const HandlerT& handler() const& { return handler_; }
+
+private: // only dispatch and mutation
+    struct step_ok {
+        std::size_t offset; // as in deserialize_ok
+        bool is_complete;
+    };
+
+    meta::result<step_ok, status_type> deserialize_impl(std::span<const std::byte> input) & {
+        const deserialize_config& config = config_;
+        return core::deserialize_step(context_, state_, config, input)
+            .and_then([&](deserialize_ok ok) -> meta::result<step_ok, status_type> {
+                state_ = std::move(ok.state);
+                if (const auto maybe_error = handle(ok.event); maybe_error.has_value()) {
+                    return meta::err(maybe_error.value());
+                }
+                return step_ok{
+                    .offset = ok.offset,
+                    .is_complete = std::holds_alternative<deserialize_event_complete>(ok.event),
+                };
+            });
+    }
+
+    meta::maybe<status_type> handle(const deserialize_event& event) & {
+        return std::visit(
+            meta::overloaded{
+                [](const deserialize_event_none&) -> meta::maybe<status_type> { return meta::null; },
+                [this](const deserialize_event_method& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_method(e.method); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_method(e.method); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_target& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_target(e.target); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_target(e.target); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_version& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_version(e.version); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_version(e.version); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_status& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_status(e.status); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_status(e.status); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_reason& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_reason(e.reason); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_reason(e.reason); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_field& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_field(e); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_field(e); });
+                    } else if constexpr (requires { handler_.on_field(e.name, e.value); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_field(e.name, e.value); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_headers&) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_headers(context_.framing); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_headers(context_.framing); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_expect&) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_expect(); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_expect(); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_chunk_ext& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_chunk_ext(e.chunk_ext); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_chunk_ext(e.chunk_ext); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_body& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_body(e.body); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_body(e.body); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_trailer& e) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_trailer(e); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_trailer(e); });
+                    } else if constexpr (requires { handler_.on_trailer(e.name, e.value); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_trailer(e.name, e.value); });
+                    }
+                    return meta::null;
+                },
+                [this](const deserialize_event_complete&) -> meta::maybe<status_type> {
+                    if constexpr (requires { handler_.on_complete(); }) {
+                        return invoke_deserialize_hook([&] { return handler_.on_complete(); });
+                    }
+                    return meta::null;
+                },
+            },
+            event
+        );
+    }
 
 private:
-    message_type output_{};
+    HandlerT handler_;
+    deserialize_context context_;
     remainder_buffer<> remainder_{}; // TODO: extract outside
     deserialize_state state_;
-    deserialize_config config_;
+    ConfigT config_;
 };
 
+// framing fields are always retained, they are needed to find where the message ends
+bool is_field_retained(const meta::maybe<field_names_type>& retained_fields, std::string_view field_key);
+
+// repeated fields are combined as per RFC 9110 5.3
+// lowercase_key is field_key already folded, if empty field_key is folded here
+// is_name_trusted interns the name, set it only when the application picked it, e.g. via retained_fields
+void append_field(
+    fields_type& fields,
+    std::string_view field_key,
+    std::string_view lowercase_key,
+    std::string_view field_value,
+    bool is_name_trusted
+);
+
+// what parse_request and parse_response use without a config
+const deserialize_config& default_parse_config();
+
+// Materializes message_type out of events and drives the deserialize_config callbacks
+class message_builder {
+public:
+    // config is referenced, not copied, and has to outlive the builder
+    message_builder(const deserialize_config& config, bool is_request);
+
+    meta::maybe<status_type> on_method(method_type method);
+    meta::maybe<status_type> on_target(std::string_view target);
+    meta::maybe<status_type> on_version(version_type version);
+    meta::maybe<status_type> on_status(status_type status);
+    meta::maybe<status_type> on_reason(std::string_view reason);
+    meta::maybe<status_type> on_field(const deserialize_event_field& field);
+    meta::maybe<status_type> on_headers(const framing_type& framing);
+    meta::maybe<status_type> on_expect();
+    meta::maybe<status_type> on_chunk_ext(std::string_view chunk_ext);
+    meta::maybe<status_type> on_body(std::span<const std::byte> body);
+    meta::maybe<status_type> on_trailer(const deserialize_event_trailer& trailer);
+    meta::maybe<status_type> on_complete();
+    meta::maybe<status_type> on_input_end();
+
+private:
+    void flush_coalesced_chunk();
+    meta::maybe<status_type> buffer_body(std::span<const std::byte> body);
+    void reset();
+
+private:
+    std::reference_wrapper<const deserialize_config> config_;
+
+    message_type output_{};
+    std::string chunk_ext_{}; // capacity is reused between chunks
+    std::vector<std::byte> coalesced_chunk_{};
+    body_mode body_mode_ = body_mode::BUFFER;
+    bool is_request_;
+};
+
+// the builder references its config, so the machine does too
+using deserialize_machine =
+    basic_deserialize_machine<message_builder, std::reference_wrapper<const deserialize_config>>;
+
 } // namespace detail
+
+// Meant to be embedded by value, e.g. in a connection: hooks of HandlerT are called directly and can be inlined,
+// config is shared and has to outlive the deserializer. See detail::basic_deserialize_machine for the hooks.
+// Nothing is allocated up front, the remainder is only buffered when a message is split between inputs.
+template <typename HandlerT, typename PolicyT = deserialize_policy>
+class basic_deserializer {
+public:
+    basic_deserializer(HandlerT handler, const deserialize_config& config, bool is_request)
+        : machine_{ std::move(handler), std::cref(config), is_request } {}
+
+    meta::maybe<status_type> operator()(std::span<const std::byte> input) & { return machine_.deserialize(input); }
+
+    // see detail::basic_deserialize_machine::deserialize_some
+    meta::result<deserialize_progress, status_type> deserialize_some(std::span<const std::byte>& input) & {
+        return machine_.deserialize_some(input);
+    }
+
+    HandlerT& handler() & { return machine_.handler(); }
+    const HandlerT& handler() const& { return machine_.handler(); }
+
+private:
+    detail::basic_deserialize_machine<HandlerT, std::reference_wrapper<const deserialize_config>, PolicyT> machine_;
+};
+
+template <typename PolicyT = deserialize_policy, typename HandlerT>
+basic_deserializer<HandlerT, PolicyT> make_request_deserializer(HandlerT handler, const deserialize_config& config) {
+    return basic_deserializer<HandlerT, PolicyT>{ std::move(handler), config, /*is_request=*/true };
+}
+
+template <typename PolicyT = deserialize_policy, typename HandlerT>
+basic_deserializer<HandlerT, PolicyT> make_response_deserializer(HandlerT handler, const deserialize_config& config) {
+    return basic_deserializer<HandlerT, PolicyT>{ std::move(handler), config, /*is_request=*/false };
+}
+
+// Event-driven deserialization, nothing is materialized unless HandlerT does it
+// See detail::basic_deserialize_machine for the hooks, callbacks in config are not used
+template <typename HandlerT>
+meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
+    make_deserialize_request(HandlerT handler, deserialize_config config) {
+    return [m = detail::basic_deserialize_machine<HandlerT>{
+                std::move(handler), std::move(config), /*is_request=*/true }] //
+        (std::span<const std::byte> input) mutable { return m.deserialize(input); };
+}
+
+template <typename HandlerT>
+meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
+    make_deserialize_response(HandlerT handler, deserialize_config config) {
+    return [m = detail::basic_deserialize_machine<HandlerT>{
+                std::move(handler), std::move(config), /*is_request=*/false }] //
+        (std::span<const std::byte> input) mutable { return m.deserialize(input); };
+}
+
 } // namespace sl::http::v1
@@ -0,0 +1,104 @@
+//
+// Created by usatiynyan.
+// Parsed message kept as the received bytes plus offsets into them.
+//
+
+#pragma once
+
+#include "sl/http/v1/deserialize/message.hpp"
+#include "sl/http/v1/deserialize/target.hpp"
+#include "sl/http/v1/types.hpp"
+
+#include <sl/meta/monad/maybe.hpp>
+#include <sl/meta/monad/result.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sl::http::v1 {
+
+// bytes [offset, offset + size) of packed_message::buffer
+struct packed_span {
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+};
+
+struct packed_field {
+    packed_span name; // as received
+    packed_span value; // without surrounding OWS
+};
+
+struct packed_parse_ok;
+
+// What parse_request and parse_response produce, in two heap blocks instead of one per name, value and bucket:
+// the buffer holds the head as received, then the decoded path, the body and the trailers,
+// fields are spans into it. Field lookups are a case-insensitive scan, repeated fields stay separate.
+// Input longer than 2 GiB is CONTENT_TOO_LARGE, the buffer holds a copy of the target besides it.
+class packed_message {
+public:
+    [[nodiscard]] bool is_request() const { return is_request_; }
+    [[nodiscard]] method_type method() const { return method_; } // request only
+    [[nodiscard]] status_type status() const { return status_; } // response only
+    [[nodiscard]] version_type version() const { return version_; }
+    [[nodiscard]] std::string_view raw_target() const { return view(target_); } // request only
+    [[nodiscard]] std::string_view reason() const { return view(reason_); } // response only
+
+    // decoded while parsing, null unless the target is in origin-form
+    [[nodiscard]] meta::maybe<origin_target_view> origin_target() const;
+
+    [[nodiscard]] std::span<const packed_field> fields() const { return fields_; }
+    [[nodiscard]] std::string_view view(packed_span span) const {
+        return std::string_view{ buffer_ }.substr(span.offset, span.size);
+    }
+    // value of the first field named lowercase_name
+    [[nodiscard]] meta::maybe<std::string_view> find_field(std::string_view lowercase_name) const;
+
+    [[nodiscard]] std::span<const std::byte> body() const;
+    [[nodiscard]] const framing_type& framing() const { return framing_; }
+    [[nodiscard]] std::string_view buffer() const { return buffer_; }
+    // start line and field section as received, up to and including the empty line
+    [[nodiscard]] std::string_view raw_head() const { return view(head_); }
+
+    // materializes the message as parse_request would have, repeated fields are combined
+    [[nodiscard]] message_type to_message() const;
+
+    static meta::result<meta::maybe<packed_parse_ok>, status_type>
+        parse(std::span<const std::byte> input, const deserialize_config& config, bool is_request);
+
+private:
+    std::string buffer_{};
+    std::vector<packed_field> fields_{}; // fields of the head come first, then trailers
+    packed_span head_{};
+    packed_span target_{};
+    packed_span reason_{};
+    packed_span path_{};
+    packed_span query_{};
+    packed_span body_{};
+    framing_type framing_{};
+    method_type method_ = method_type::ENUM_END;
+    status_type status_ = status_type::ENUM_END;
+    version_type version_ = version_type::ENUM_END;
+    bool is_request_ = true;
+    bool is_origin_form_ = false;
+};
+
+struct packed_parse_ok {
+    packed_message message;
+    std::size_t offset; // bytes consumed, whatever follows belongs to the next message
+};
+
+// Same as parse_request and parse_response, see packed_message, except that input which ends before the message
+// does is null rather than BAD_REQUEST: parse again once more of it has arrived.
+meta::result<meta::maybe<packed_parse_ok>, status_type> parse_packed_request(std::span<const std::byte> input);
+meta::result<meta::maybe<packed_parse_ok>, status_type>
+    parse_packed_request(std::span<const std::byte> input, const deserialize_config& config);
+
+meta::result<meta::maybe<packed_parse_ok>, status_type> parse_packed_response(std::span<const std::byte> input);
+meta::result<meta::maybe<packed_parse_ok>, status_type>
+    parse_packed_response(std::span<const std::byte> input, const deserialize_config& config);
+
+} // namespace sl::http::v1
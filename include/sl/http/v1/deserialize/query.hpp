@@ -0,0 +1,107 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "sl/http/v1/types/fields.hpp"
+
+#include <sl/meta/monad/maybe.hpp>
+
+#include <tsl/robin_map.h>
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace sl::http::v1 {
+
+// key=value pair exactly as it appears in the query, not percent-decoded
+// "flag" (no '=') yields an empty value
+struct query_param_view {
+    std::string_view key;
+    std::string_view value;
+};
+
+// Zero-copy view over a query string (without leading '?')
+// Iteration yields raw pairs, lookups decode only what has to be decoded and never allocate before the index.
+// After index_threshold lookups a hash index of decoded keys is built, so lookups become O(1).
+// Lookups mutate the lazy index, so a single query_view must not be shared between threads.
+class query_view {
+public:
+    static constexpr std::size_t index_threshold = 4;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = query_param_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const query_param_view*;
+        using reference = const query_param_view&;
+
+    public:
+        iterator() = default;
+        explicit iterator(std::string_view tail) : tail_{ tail }, has_tail_{ !tail.empty() } { advance(); }
+
+        reference operator*() const { return current_; }
+        pointer operator->() const { return &current_; }
+
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator copy = *this;
+            advance();
+            return copy;
+        }
+
+        bool operator==(const iterator& other) const {
+            return is_end_ == other.is_end_ && (is_end_ || current_.key.data() == other.current_.key.data());
+        }
+
+    private:
+        void advance();
+
+    private:
+        std::string_view tail_{};
+        query_param_view current_{};
+        bool has_tail_ = false;
+        bool is_end_ = true;
+    };
+
+public:
+    query_view() = default;
+    explicit query_view(std::string_view query_str) : query_str_{ query_str } {}
+
+    [[nodiscard]] iterator begin() const { return iterator{ query_str_ }; }
+    [[nodiscard]] iterator end() const { return iterator{}; }
+
+    [[nodiscard]] std::string_view raw() const { return query_str_; }
+    [[nodiscard]] bool empty() const { return begin() == end(); }
+
+    // Raw value of the first param whose decoded key equals `key`
+    meta::maybe<std::string_view> find_raw(std::string_view key) const;
+
+    // Decoded value of the first param whose decoded key equals `key`
+    // A value without escapes is returned as is, otherwise it's decoded into the front of `buffer`
+    // Returns null if key is absent, value is malformed or `buffer` is shorter than the raw value
+    meta::maybe<std::string_view> find(std::string_view key, std::span<char> buffer) const;
+
+    bool contains(std::string_view key) const { return find_raw(key).has_value(); }
+
+private:
+    meta::maybe<std::string_view> find_raw_scan(std::string_view key) const;
+    void build_index() const;
+
+private:
+    using index_type = tsl::robin_map<std::string, std::string_view, detail::string_hash, detail::string_equal>;
+
+    std::string_view query_str_{};
+    mutable std::size_t lookup_count_ = 0;
+    mutable meta::maybe<index_type> index_{};
+};
+
+} // namespace sl::http::v1
@@ -4,14 +4,23 @@
 
 #pragma once
 
+#include "sl/http/v1/deserialize/query.hpp"
 #include "sl/http/v1/types/target.hpp"
 
 #include <sl/meta/monad/maybe.hpp>
 
+#include <span>
 #include <string_view>
 
 namespace sl::http::v1 {
 
+// origin-form over a caller-owned buffer, nothing is allocated
+// path is percent-decoded in place, query is kept encoded and decoded on lookup
+struct origin_target_view {
+    std::string_view path;
+    query_view query;
+};
+
 // Main entry point - dispatches to specific form deserializers based on prefix
 meta::maybe<target_type> deserialize_target(std::string_view target_str);
 
@@ -20,6 +29,10 @@ namespace detail {
 // Parse origin-form: absolute-path [ "?" query ]
 meta::maybe<origin_target_type> deserialize_origin_form(std::string_view target_str);
 
+// Parse origin-form decoding the path inside `target_buffer`
+// Returned views point into `target_buffer`, which is clobbered even on failure
+meta::maybe<origin_target_view> deserialize_origin_form_in_place(std::span<char> target_buffer);
+
 // Parse absolute-form: absolute-URI (http:// or https://)
 meta::maybe<absolute_target_type> deserialize_absolute_form(std::string_view target_str);
 
@@ -37,6 +50,11 @@ struct percent_decode {
     // Returns decoded string or null if any sequence is invalid
     static meta::maybe<std::string> str(std::string_view encoded);
 
+    // In-place variants: decoded form is never longer than the encoded one,
+    // so it is written over the front of `encoded` and returned as a view into it
+    static meta::maybe<std::string_view> query_in_place(std::span<char> encoded);
+    static meta::maybe<std::string_view> str_in_place(std::span<char> encoded);
+
     // Decode a single percent-encoded sequence (2 hex digits after %)
     // Returns decoded char or null if invalid hex
     static meta::maybe<char> byte(char high, char low);
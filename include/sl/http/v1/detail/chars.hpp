@@ -0,0 +1,76 @@
+//
+// Created by usatiynyan.
+// Byte classification tables, indexed by unsigned char.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sl::http::v1::detail::chars {
+
+constexpr std::uint8_t invalid_hex = 0xFF;
+
+// HEXDIG value or invalid_hex
+constexpr std::array<std::uint8_t, 256> hex_values = [] {
+    std::array<std::uint8_t, 256> table{};
+    table.fill(invalid_hex);
+    for (std::uint8_t i = 0; i < 10; ++i) {
+        table['0' + i] = i;
+    }
+    for (std::uint8_t i = 0; i < 6; ++i) {
+        table['A' + i] = static_cast<std::uint8_t>(10 + i);
+        table['a' + i] = static_cast<std::uint8_t>(10 + i);
+    }
+    return table;
+}();
+
+constexpr std::uint8_t hex_value(char c) { return hex_values[static_cast<std::uint8_t>(c)]; }
+
+// character classes, combined as bit flags
+constexpr std::uint8_t unreserved = 1 << 0; // ALPHA / DIGIT / "-" / "." / "_" / "~"
+constexpr std::uint8_t path_safe = 1 << 1; // unreserved / "/" / ":" / "@" / sub-delims
+constexpr std::uint8_t tchar = 1 << 2; // ALPHA / DIGIT / "!#$%&'*+-.^_`|~", RFC 9110 5.6.2
+
+constexpr std::array<std::uint8_t, 256> classes = [] {
+    std::array<std::uint8_t, 256> table{};
+    const auto add = [&table](char c, std::uint8_t cls) { table[static_cast<std::uint8_t>(c)] |= cls; };
+    constexpr std::uint8_t unreserved_cls = unreserved | path_safe | tchar;
+    for (char c = 'A'; c <= 'Z'; ++c) {
+        add(c, unreserved_cls);
+        add(static_cast<char>(c - 'A' + 'a'), unreserved_cls);
+    }
+    for (char c = '0'; c <= '9'; ++c) {
+        add(c, unreserved_cls);
+    }
+    for (char c : { '-', '.', '_', '~' }) {
+        add(c, unreserved_cls);
+    }
+    for (char c : { '/', ':', '@', '!', '$', '&', '\'', '(', ')', '*', '+', ',', ';', '=' }) {
+        add(c, path_safe);
+    }
+    for (char c : { '!', '#', '$', '%', '&', '\'', '*', '+', '^', '`', '|' }) {
+        add(c, tchar);
+    }
+    return table;
+}();
+
+constexpr bool is(char c, std::uint8_t cls) { return (classes[static_cast<std::uint8_t>(c)] & cls) != 0; }
+
+// ASCII lowercase, other bytes map to themselves
+constexpr std::array<char, 256> lowercase = [] {
+    std::array<char, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = static_cast<char>(i);
+    }
+    for (char c = 'A'; c <= 'Z'; ++c) {
+        table[static_cast<std::uint8_t>(c)] = static_cast<char>(c - 'A' + 'a');
+    }
+    return table;
+}();
+
+constexpr char to_lower(char c) { return lowercase[static_cast<std::uint8_t>(c)]; }
+
+} // namespace sl::http::v1::detail::chars
@@ -0,0 +1,19 @@
+//
+// Created by usatiynyan.
+// Seeded hashing for maps keyed by untrusted input.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace sl::http::v1::detail {
+
+// SipHash-1-3 keyed with a random per-process seed, so colliding keys can't be precomputed
+std::size_t seeded_hash(std::string_view str) noexcept;
+
+// same as seeded_hash(to_lowercase(str)), without the allocation
+std::size_t seeded_hash_lowercase(std::string_view str) noexcept;
+
+} // namespace sl::http::v1::detail
@@ -0,0 +1,32 @@
+//
+// Created by usatiynyan.
+// Process-wide interning of field names.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace sl::http::v1::detail {
+
+struct interned_field_name {
+    std::string name;
+    std::size_t hash; // seeded_hash(name)
+};
+
+// Common field names are interned from the start, unknown ones are added until the table holds
+// max_interned_field_name_count names, after that null is returned. Entries live until the process exits.
+// Lookups are lock-free, concurrent inserts of the same name yield the same entry.
+// Only for names the application chooses, a peer could fill the table with junk otherwise.
+const interned_field_name* intern_field_name(std::string_view name);
+
+// Never inserts, null if name is not interned. Safe for names chosen by the peer.
+const interned_field_name* find_interned_field_name(std::string_view name);
+
+std::size_t interned_field_name_count();
+
+inline constexpr std::size_t max_interned_field_name_count = 2048;
+
+} // namespace sl::http::v1::detail
@@ -11,6 +11,8 @@
 
 #include <cstddef>
 #include <span>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace sl::http::v1::detail {
@@ -42,6 +44,18 @@ public:
         return offset;
     }
 
+    // Appends up to size bytes written in place by fill(std::span<std::byte>), which returns how many it wrote
+    template <typename F>
+    std::size_t fill(std::size_t size, F&& f) {
+        std::ignore = merge({});
+        const std::size_t old_size = buffer_.size();
+        buffer_.resize(old_size + size);
+        const std::size_t filled_size = std::forward<F>(f)(std::span{ buffer_ }.subspan(old_size));
+        ASSERT(filled_size <= size);
+        buffer_.resize(old_size + filled_size);
+        return filled_size;
+    }
+
     void add_offset(std::size_t offset) {
         ASSERT(offset_ + offset <= buffer_.size());
         offset_ += offset;
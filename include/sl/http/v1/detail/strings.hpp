@@ -8,6 +8,7 @@
 #include <sl/meta/enum/to_string.hpp>
 #include <sl/meta/monad/result.hpp>
 
+#include <concepts>
 #include <span>
 #include <string>
 #include <string_view>
@@ -32,6 +33,9 @@ constexpr auto is_ws(char c) { return c == ' ' || c == '\t'; }
 std::string to_lowercase(std::string_view str);
 bool is_lowercase(std::string_view str);
 
+// Case-insensitive comparison against an already lowercase string
+bool equals_lowercase(std::string_view str, std::string_view lowercase);
+
 std::string_view strip_prefix(std::string_view str, std::string_view prefix);
 std::string_view strip_suffix(std::string_view str, std::string_view suffix);
 
@@ -51,6 +55,25 @@ inline std::string_view strip_suffix_while(std::string_view str, std::predicate<
     return str;
 }
 
+// #rule: elements separated by ",", with OWS around them, empty elements are skipped
+inline void for_each_list_element(std::string_view list, std::invocable<std::string_view> auto f) {
+    while (true) {
+        const auto comma = list.find(',');
+        const auto element = strip_suffix_while(strip_prefix_while(list.substr(0, comma), tokens::is_ws), tokens::is_ws);
+        if (!element.empty()) {
+            f(element);
+        }
+        if (comma == std::string_view::npos) {
+            return;
+        }
+        list.remove_prefix(comma + 1);
+    }
+}
+
+// Scans 8 bytes per step for either of two bytes
+// Returns std::string_view::npos if neither is present
+std::size_t find_first_of(std::string_view str, char a, char b);
+
 struct find_ok {
     std::string_view value;
     std::size_t offset;
@@ -73,6 +96,24 @@ meta::result<find_ok, find_err> try_find(std::string_view str_buffer, std::strin
 find_split_result try_find_split_unlimited(std::string_view str_buffer, std::string_view delim);
 find_split_result try_find_split(std::string_view str_buffer, std::string_view delim, std::size_t max_size);
 
+struct field_line_ok {
+    std::string_view name; // as received, empty for the line ending the field section
+    std::string_view lowercase_name; // folded into lowercase_buffer, empty if it didn't fit
+    std::string_view value; // without surrounding OWS
+    std::size_t offset; // past CRLF
+};
+
+enum class field_line_err {
+    NOT_FOUND,
+    MAX_SIZE_EXCEEDED,
+    MALFORMED,
+};
+
+// field-line CRLF in a single pass: field-name is validated as a token and folded while looking for ":",
+// then the value is trimmed of OWS around it. max_size limits the line without CRLF, as in try_find.
+meta::result<field_line_ok, field_line_err>
+    scan_field_line(std::string_view str_buffer, std::size_t max_size, std::span<char> lowercase_buffer);
+
 template <typename EnumT>
 constexpr std::size_t enum_max_str_length() {
     std::size_t max_str_length = 0;
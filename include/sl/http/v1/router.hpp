@@ -0,0 +1,193 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "sl/http/v1/types.hpp"
+
+#include <sl/meta/monad/maybe.hpp>
+#include <sl/meta/monad/result.hpp>
+
+#include <tsl/robin_map.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace sl::http::v1 {
+
+// bit per method_type
+using method_mask = std::uint16_t;
+static_assert(static_cast<std::size_t>(method_type::ENUM_END) <= sizeof(method_mask) * 8);
+
+constexpr method_mask method_bit(method_type method) {
+    return static_cast<method_mask>(1u << static_cast<std::uint8_t>(method));
+}
+
+struct route_capture {
+    std::string_view name; // points into the router
+    std::string_view value; // points into the matched path, still percent-encoded as received
+};
+
+// Fixed capacity, so matching never allocates
+class route_captures {
+public:
+    static constexpr std::size_t max_size = 8;
+
+    [[nodiscard]] const route_capture* begin() const { return captures_.data(); }
+    [[nodiscard]] const route_capture* end() const { return captures_.data() + size_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] const route_capture& operator[](std::size_t i) const { return captures_[i]; }
+
+    [[nodiscard]] meta::maybe<std::string_view> find(std::string_view name) const {
+        for (const auto& capture : *this) {
+            if (capture.name == name) {
+                return capture.value;
+            }
+        }
+        return meta::null;
+    }
+
+    void push(route_capture capture) { captures_[size_++] = capture; }
+    void pop() { --size_; }
+
+private:
+    std::array<route_capture, max_size> captures_{};
+    std::size_t size_ = 0;
+};
+
+namespace detail {
+
+// Compressed radix tree over '/'-separated segments
+// pattern segments: "name" - static, ":name" - single segment capture, "*name" - rest of the path capture (last only)
+// Static segments are preferred over captures, captures over the wildcard, with backtracking between them.
+// A node always sits at the same segment of the path, so backtracking tries each node at most once: a match costs
+// O(path length) along one branch, times the number of branches that dead-end on the way.
+// A segment with escapes is compared against every static child instead of being looked up.
+class route_tree {
+public:
+    using value_index = std::uint32_t;
+
+    struct match_type {
+        value_index index;
+        route_captures captures;
+    };
+
+public:
+    route_tree();
+
+    std::error_code insert(method_type method, std::string_view pattern, value_index index);
+
+    // NOT_FOUND if no route matches path, METHOD_NOT_ALLOWED if some do but not for this method
+    // An encoded path is split into segments first and each is decoded on comparison, so "%2F" never splits one.
+    meta::result<match_type, status_type> match(method_type method, std::string_view path, bool is_encoded) const;
+
+private:
+    static constexpr value_index no_index = ~value_index{};
+    using node_index = std::uint32_t;
+
+    struct endpoint_type {
+        method_mask methods = 0;
+        std::array<value_index, static_cast<std::size_t>(method_type::ENUM_END)> values{};
+    };
+
+    struct node_type {
+        std::string label; // one or more static segments, joined by '/'
+        tsl::robin_map<std::string, node_index, string_hash, string_equal> children; // by first segment of label
+        meta::maybe<node_index> param{};
+        meta::maybe<node_index> wildcard{};
+        std::string capture_name; // for param and wildcard nodes
+        endpoint_type endpoint{};
+    };
+
+    struct match_state {
+        method_mask method_bit;
+        bool is_encoded; // path has escapes left
+        route_captures captures{};
+        const endpoint_type* endpoint = nullptr;
+        bool is_path_matched = false;
+    };
+
+private:
+    node_index make_node(std::string label);
+    void insert_static(node_index& current, std::string_view run);
+
+    bool match_node(node_index node, std::string_view rest, match_state& state) const;
+    bool match_after(node_index node, std::string_view tail, match_state& state) const;
+    bool match_children(node_index node, std::string_view rest, match_state& state) const;
+    static bool match_endpoint(const endpoint_type& endpoint, match_state& state);
+
+private:
+    std::vector<node_type> nodes_;
+};
+
+} // namespace detail
+
+template <typename ValueT>
+struct route_match {
+    const ValueT& value;
+    route_captures captures;
+};
+
+// Dispatches requests by method and path to values (usually handlers)
+template <typename ValueT>
+class router {
+public:
+    // pattern e.g.: "/users/:id/files/*path", static segments as they are once decoded
+    std::error_code add(method_type method, std::string_view pattern, ValueT value) {
+        const auto index = static_cast<detail::route_tree::value_index>(values_.size());
+        if (const auto ec = tree_.insert(method, pattern, index)) {
+            return ec;
+        }
+        values_.push_back(std::move(value));
+        return {};
+    }
+
+    // path as received, still percent-encoded, e.g. "/files/a%2Fb" is a single segment
+    meta::result<route_match<ValueT>, status_type> match(method_type method, std::string_view path) const {
+        return match_impl(method, path, /*is_encoded=*/true);
+    }
+
+    // routes the raw path when the received one had escapes, the decoded one holds none otherwise
+    meta::result<route_match<ValueT>, status_type> match(method_type method, const target_type& target) const {
+        if (const auto* origin = std::get_if<origin_target_type>(&target)) {
+            return match_target_path(method, origin->path, origin->raw_path);
+        }
+        if (const auto* absolute = std::get_if<absolute_target_type>(&target)) {
+            return match_target_path(method, absolute->path, absolute->raw_path);
+        }
+        return meta::err(status_type::NOT_FOUND);
+    }
+
+    meta::result<route_match<ValueT>, status_type> match(const request_line_type& request_line) const {
+        return match(request_line.method, request_line.target);
+    }
+
+private:
+    meta::result<route_match<ValueT>, status_type>
+        match_target_path(method_type method, std::string_view path, std::string_view raw_path) const {
+        return raw_path.empty() ? match_impl(method, path, /*is_encoded=*/false)
+                                : match_impl(method, raw_path, /*is_encoded=*/true);
+    }
+
+    meta::result<route_match<ValueT>, status_type>
+        match_impl(method_type method, std::string_view path, bool is_encoded) const {
+        return tree_.match(method, path, is_encoded).map([this](detail::route_tree::match_type tree_match) {
+            return route_match<ValueT>{
+                .value = values_[tree_match.index],
+                .captures = tree_match.captures,
+            };
+        });
+    }
+
+private:
+    detail::route_tree tree_;
+    std::vector<ValueT> values_;
+};
+
+} // namespace sl::http::v1
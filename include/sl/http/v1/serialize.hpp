@@ -5,4 +5,5 @@
 #pragma once
 
 #include "sl/http/v1/serialize/message.hpp"
+#include "sl/http/v1/serialize/packed.hpp"
 
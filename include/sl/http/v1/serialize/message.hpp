@@ -8,17 +8,29 @@
 #include "sl/http/v1/types.hpp"
 
 #include <sl/meta/func/function.hpp>
+#include <sl/meta/monad/maybe.hpp>
+#include <sl/meta/monad/result.hpp>
+
+#include <system_error>
 
 namespace sl::http::v1 {
 
 struct serialize_config {
     std::size_t buffer_size = 1024;
+    // Version of the message being answered. framing.connection is written as a Connection field unless it is
+    // the default of both this version and the message's own, unknown means it is always written.
+    meta::maybe<version_type> peer_version{};
     // bool is_chunked = false; TODO
 };
 
-meta::unique_function<std::span<const std::byte>(std::size_t written)>
+// An empty span ends the message. An error means it can't be completed, e.g. message_type::body_file failed
+// to read, and the connection has to be closed: the peer has part of a message already.
+meta::unique_function<meta::result<std::span<const std::byte>, std::error_code>(std::size_t written)>
     make_serialize(const message_type& message, serialize_config config);
 
+// Prebuilt "HTTP/1.1 100 Continue" interim response, answers "Expect: 100-continue"
+std::span<const std::byte> serialize_continue();
+
 namespace detail {
 
 struct serialize_state_start_line {};
@@ -28,24 +40,33 @@ struct serialize_state_fields {
 struct serialize_state_body {
     std::size_t offset = 0;
 };
+// message_type::body_file is read through the buffer
+struct serialize_state_body_file {
+    std::size_t offset = 0;
+};
 // struct serialize_state_chunked_body {}; TODO
 // struct serialize_state_trailing_fields {}; TODO
 struct serialize_state_complete {};
+struct serialize_state_error {
+    std::error_code error;
+};
 
 using serialize_state = std::variant<
     serialize_state_start_line,
     serialize_state_fields,
     serialize_state_body,
+    serialize_state_body_file,
     // serialize_state_chunked_body, TODO
     // serialize_state_trailing_fields, TODO
-    serialize_state_complete>;
+    serialize_state_complete,
+    serialize_state_error>;
 
 struct serialize_machine {
     constexpr serialize_machine(const message_type& message, serialize_config config)
         : remainder_{ config.buffer_size }, state_{ serialize_state_start_line{} }, config_{ std::move(config) },
           message_{ message } {}
 
-    std::span<const std::byte> resume(std::size_t written) &;
+    meta::result<std::span<const std::byte>, std::error_code> resume(std::size_t written) &;
 
 public: // transparent
     static serialize_state resume_impl(
@@ -66,6 +87,12 @@ public: // transparent
         const serialize_config& config,
         const serialize_state_body& state
     );
+    static serialize_state resume_impl(
+        const message_type& message,
+        remainder_buffer<>& remainder,
+        const serialize_config& config,
+        const serialize_state_body_file& state
+    );
 
 private:
     remainder_buffer<> remainder_;
@@ -0,0 +1,41 @@
+//
+// Created by usatiynyan.
+// Forwarding a received head with edits, without re-encoding it.
+//
+
+#pragma once
+
+#include "sl/http/v1/deserialize/packed.hpp"
+#include "sl/http/v1/types/fields.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sl::http::v1 {
+
+// Changes to a received head, names are case-insensitive.
+// Only fields the message retained can be removed or replaced, see deserialize_config::retained_fields.
+struct head_edits {
+    field_names_type removed{}; // every field of the name is dropped
+    // the first field of the name keeps its place and casing and gets the value, the rest are dropped,
+    // appended as given if there is no such field
+    std::vector<std::pair<std::string, std::string>> replaced{};
+    std::vector<std::pair<std::string, std::string>> added{}; // appended in order after the received fields
+
+    [[nodiscard]] bool empty() const { return removed.empty() && replaced.empty() && added.empty(); }
+};
+
+// Fills output with the pieces of message.raw_head() with edits applied, in order, ready for a gathering write.
+// Untouched runs of lines are single pieces into the received bytes, so without edits output is raw_head() itself.
+// Pieces point into message, edits and static storage. The body is left to the caller: framing fields
+// describe the body as received, and a chunked body is already joined in packed_message::body().
+void serialize_head(
+    const packed_message& message,
+    const head_edits& edits,
+    std::vector<std::span<const std::byte>>& output
+);
+
+} // namespace sl::http::v1
@@ -21,15 +21,16 @@ struct percent_encode {
     static bool is_unreserved(char c);
     static bool is_path_safe(char c);
 
-    static std::size_t path_size(std::string_view path);
-    static std::size_t query_size(const query_params& query);
-    static std::size_t query_size(std::string_view query_str);
+    // Size before escaping, '?' or '&' and '=' of every pair included. Only sums the pairs to reserve,
+    // escapes grow the string as serialize_query appends them.
+    static std::size_t unescaped_query_size(const query_params& query);
 
     static void append(std::string& result, char c);
 
     // Encode string for use in URI path component
     // Encodes all chars except: ALPHA / DIGIT / "-" / "." / "_" / "~" / ":" / "@" / "!" / "$" / "&" / "'" / "(" / ")" /
     // "*" / "+" / "," / ";" / "=" Note: "/" is NOT encoded (path separator)
+    // Runs of safe chars are appended in bulk, so the output is sized in the same pass
     static void serialize_path(std::string& result, std::string_view path);
 
     // Encode string for use in query key or value
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include "sl/http/v1/types/body_file.hpp"
 #include "sl/http/v1/types/fields.hpp"
+#include "sl/http/v1/types/framing.hpp"
 #include "sl/http/v1/types/method.hpp"
 #include "sl/http/v1/types/status.hpp"
 #include "sl/http/v1/types/target.hpp"
@@ -34,6 +36,10 @@ struct message_type {
     fields_type fields; // can be empty
     body_type body; // can be empty
     start_line_type start_line;
+    framing_type framing{}; // filled by deserialization, only connection is used by serialization
+    // set instead of body when deserialization spilled it, see deserialize_config::body_spill_size
+    // serialization reads it through its buffer, sendfile avoids the copy
+    meta::maybe<body_file_type> body_file{};
 };
 
 } // namespace sl::http::v1
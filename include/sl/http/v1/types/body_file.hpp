@@ -0,0 +1,47 @@
+//
+// Created by usatiynyan.
+// Body kept in an unlinked temporary file instead of memory.
+//
+
+#pragma once
+
+#include <sl/meta/monad/result.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace sl::http::v1 {
+namespace detail {
+
+struct body_file_state;
+
+} // namespace detail
+
+// The file is opened with O_TMPFILE, so it has no name and is gone once the last copy of the handle is.
+// Copies share the file and its size. Reads and writes are positional, the file offset is never used.
+class body_file_type {
+public:
+    // where the filesystem of directory has no O_TMPFILE, a named file is created and unlinked right away
+    static meta::result<body_file_type, std::error_code> create(const std::string& directory);
+
+    std::error_code append(std::span<const std::byte> data);
+
+    // Returns how many bytes were read, less than buffer.size() only at the end of the file
+    meta::result<std::size_t, std::error_code> read(std::size_t offset, std::span<std::byte> buffer) const;
+
+    [[nodiscard]] std::size_t size() const;
+    // for mmap and sendfile, stays owned by the handle
+    [[nodiscard]] int fd() const;
+
+private:
+    explicit body_file_type(std::shared_ptr<detail::body_file_state> state) : state_{ std::move(state) } {}
+
+private:
+    std::shared_ptr<detail::body_file_state> state_;
+};
+
+} // namespace sl::http::v1
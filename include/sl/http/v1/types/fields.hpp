@@ -4,19 +4,32 @@
 
 #pragma once
 
+#include "sl/http/v1/detail/chars.hpp"
+#include "sl/http/v1/detail/hash.hpp"
+#include "sl/http/v1/detail/intern.hpp"
+
 #include <sl/meta/monad/maybe.hpp>
 
 #include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
 
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <string>
 #include <string_view>
+#include <utility>
 
 namespace sl::http::v1 {
 namespace detail {
 
+// seeded, field names and query parameters are chosen by the peer
 struct string_hash {
     using is_transparent = void;
-    std::size_t operator()(std::string_view sv) const noexcept { return std::hash<std::string_view>{}(sv); }
+    std::size_t operator()(std::string_view sv) const noexcept { return seeded_hash(sv); }
 };
 
 struct string_equal {
@@ -24,8 +37,213 @@ struct string_equal {
     bool operator()(std::string_view lhs, std::string_view rhs) const noexcept { return lhs == rhs; }
 };
 
+// field names are case-insensitive, RFC 9110 5.1
+struct case_insensitive_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view sv) const noexcept { return seeded_hash_lowercase(sv); }
+};
+
+struct case_insensitive_equal {
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const noexcept {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+            if (chars::to_lower(lhs[i]) != chars::to_lower(rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// name of field_key_v, folded to lowercase at compile time
+template <std::size_t N>
+struct field_name_literal {
+    consteval field_name_literal(const char (&name)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            value[i] = chars::to_lower(name[i]);
+        }
+    }
+
+    constexpr std::string_view view() const { return std::string_view{ value, N - 1 }; }
+
+    char value[N]{};
+};
+
+} // namespace detail
+
+// Key of fields_type, pointer-sized: interned names are shared process-wide and compared by identity.
+// Any other name is owned by its field_name and compared by value, see interned() to intern one.
+// Owned names of up to 7 characters are stored inline, longer ones in one heap block with their hash.
+class field_name {
+public:
+    field_name(std::string_view name) : field_name{ name, detail::find_interned_field_name(name) } {}
+    field_name(const std::string& name) : field_name{ std::string_view{ name } } {}
+    field_name(const char* name) : field_name{ std::string_view{ name } } {}
+
+    // adds name to the intern table, only for names the application chooses
+    static field_name interned(std::string_view name) { return field_name{ name, detail::intern_field_name(name) }; }
+
+    field_name(const field_name& other) : bits_{ other.is_heap() ? own(other.view(), other.hash()) : other.bits_ } {}
+    field_name(field_name&& other) noexcept : bits_{ std::exchange(other.bits_, empty_bits()) } {}
+    field_name& operator=(field_name other) noexcept {
+        std::swap(bits_, other.bits_);
+        return *this;
+    }
+    ~field_name() {
+        if (is_heap()) {
+            ::operator delete(reinterpret_cast<void*>(bits_ & ~tag_mask));
+        }
+    }
+
+    std::string_view view() const {
+        switch (tag()) {
+        case interned_tag:
+            return entry()->name;
+        case heap_tag:
+            return std::string_view{ heap()->data(), heap()->size };
+        default:
+            return std::string_view{ inline_data(), (bits_ & 0xff) >> tag_bits };
+        }
+    }
+    operator std::string_view() const { return view(); }
+    std::size_t hash() const {
+        switch (tag()) {
+        case interned_tag:
+            return entry()->hash;
+        case heap_tag:
+            return heap()->hash;
+        default:
+            return detail::seeded_hash(view());
+        }
+    }
+    bool is_interned() const { return tag() == interned_tag; }
+
+    // templated so that string literals pick the std::string_view overload
+    template <std::same_as<field_name> T>
+    friend bool operator==(const field_name& lhs, const T& rhs) {
+        if (lhs.is_interned() && rhs.is_interned()) {
+            return lhs.bits_ == rhs.bits_;
+        }
+        return lhs.view() == rhs.view();
+    }
+    friend bool operator==(const field_name& lhs, std::string_view rhs) { return lhs.view() == rhs; }
+
+private:
+    // followed by size characters
+    struct heap_name {
+        std::size_t hash;
+        std::size_t size;
+
+        const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    field_name(std::string_view name, const detail::interned_field_name* entry)
+        : bits_{ reinterpret_cast<std::uintptr_t>(entry) } {
+        if (bits_ != 0) {
+            return;
+        }
+        if (name.size() <= max_inline_size) {
+            bits_ = (name.size() << tag_bits) | inline_tag;
+            std::memcpy(inline_data(), name.data(), name.size());
+        } else {
+            bits_ = own(name, detail::seeded_hash(name));
+        }
+    }
+
+    static constexpr std::uintptr_t tag_bits = 2;
+    static constexpr std::uintptr_t tag_mask = (std::uintptr_t{ 1 } << tag_bits) - 1;
+    static constexpr std::uintptr_t interned_tag = 0;
+    static constexpr std::uintptr_t heap_tag = 1;
+    static constexpr std::uintptr_t inline_tag = 2;
+    // the byte holding the tag and size is the least significant one, the rest hold the characters
+    static constexpr std::size_t max_inline_size = sizeof(std::uintptr_t) - 1;
+    static constexpr std::size_t inline_offset = std::endian::native == std::endian::little ? 1 : 0;
+
+    static std::uintptr_t own(std::string_view name, std::size_t hash) {
+        void* memory = ::operator new(sizeof(heap_name) + name.size());
+        auto* entry = ::new (memory) heap_name{ .hash = hash, .size = name.size() };
+        std::memcpy(reinterpret_cast<char*>(entry + 1), name.data(), name.size());
+        return reinterpret_cast<std::uintptr_t>(entry) | heap_tag;
+    }
+    static std::uintptr_t empty_bits() { return reinterpret_cast<std::uintptr_t>(detail::intern_field_name("")); }
+
+    std::uintptr_t tag() const { return bits_ & tag_mask; }
+    bool is_heap() const { return tag() == heap_tag; }
+    const detail::interned_field_name* entry() const {
+        return reinterpret_cast<const detail::interned_field_name*>(bits_);
+    }
+    const heap_name* heap() const { return reinterpret_cast<const heap_name*>(bits_ & ~tag_mask); }
+    char* inline_data() { return reinterpret_cast<char*>(&bits_) + inline_offset; }
+    const char* inline_data() const { return reinterpret_cast<const char*>(&bits_) + inline_offset; }
+
+private:
+    std::uintptr_t bits_;
+};
+
+namespace detail {
+
+struct field_name_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view sv) const noexcept { return seeded_hash(sv); }
+    template <std::same_as<field_name> T>
+    std::size_t operator()(const T& name) const noexcept {
+        return name.hash();
+    }
+};
+
+struct field_name_equal {
+    using is_transparent = void;
+    bool operator()(const field_name& lhs, std::string_view rhs) const noexcept { return lhs == rhs; }
+    template <std::same_as<field_name> T>
+    bool operator()(const field_name& lhs, const T& rhs) const noexcept {
+        return lhs == rhs;
+    }
+};
+
 } // namespace detail
 
-using fields_type = tsl::robin_map<std::string, std::string, detail::string_hash, detail::string_equal>;
+using field_names_type = tsl::robin_set<std::string, detail::case_insensitive_hash, detail::case_insensitive_equal>;
+
+using fields_type = tsl::robin_map<field_name, std::string, detail::field_name_hash, detail::field_name_equal>;
+
+// Field name for repeated lookups, lowercase as deserialized keys are. Holds the interned field_name,
+// so a lookup neither hashes nor compares characters. The hash is seeded per process and can't be
+// a compile-time constant, so keep keys around, e.g. in a static or as field_key_v<"Content-Type">.
+class field_key {
+public:
+    explicit field_key(std::string_view name) : name_{ field_name::interned(fold(name)) } {}
+
+    const field_name& name() const { return name_; }
+    std::size_t hash() const { return name_.hash(); }
+
+private:
+    static std::string fold(std::string_view name) {
+        std::string folded{ name };
+        for (char& c : folded) {
+            c = detail::chars::to_lower(c);
+        }
+        return folded;
+    }
+
+private:
+    field_name name_;
+};
+
+// hashed once on startup
+template <detail::field_name_literal Name>
+inline const field_key field_key_v{ Name.view() };
+
+inline fields_type::iterator find_field(fields_type& fields, const field_key& key) {
+    return fields.find(key.name(), key.hash());
+}
+inline fields_type::const_iterator find_field(const fields_type& fields, const field_key& key) {
+    return fields.find(key.name(), key.hash());
+}
+inline bool contains_field(const fields_type& fields, const field_key& key) {
+    return fields.contains(key.name(), key.hash());
+}
 
 } // namespace sl::http::v1
@@ -0,0 +1,65 @@
+//
+// Created by usatiynyan.
+// https://www.rfc-editor.org/rfc/rfc9112#section-6
+//
+
+#pragma once
+
+#include "sl/http/v1/types/version.hpp"
+
+#include <sl/meta/monad/maybe.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sl::http::v1 {
+
+// Expect = #expectation
+enum class expect_type : std::uint8_t {
+    NONE,
+    CONTINUE, // "100-continue", the only expectation defined
+    UNKNOWN,
+};
+
+// Connection persistence after the message, RFC 9112 9.3
+enum class connection_type : std::uint8_t {
+    UNSPECIFIED, // version default
+    KEEP_ALIVE,
+    CLOSE,
+    UPGRADE, // switch protocols, RFC 9110 7.8
+};
+
+constexpr connection_type default_connection(version_type version) {
+    return version == version_type::HTTPv1_0 ? connection_type::CLOSE : connection_type::KEEP_ALIVE;
+}
+
+// Framing and connection control, decoded from
+// Content-Length, Transfer-Encoding, Connection, Expect and Upgrade as soon as their field lines are parsed
+struct framing_type {
+    meta::maybe<std::size_t> content_length{};
+    bool has_transfer_encoding = false;
+    bool is_chunked = false; // "chunked" is the final transfer coding
+    bool has_connection_close = false;
+    bool has_connection_keep_alive = false;
+    bool has_connection_upgrade = false;
+    bool has_upgrade = false;
+    expect_type expect = expect_type::NONE;
+    connection_type connection = connection_type::UNSPECIFIED; // verdict, see connection_verdict
+};
+
+// "close" always wins, "upgrade" needs both the Connection option and the Upgrade field,
+// otherwise HTTP/1.0 needs "keep-alive" to persist and HTTP/1.1 persists by default
+constexpr connection_type connection_verdict(const framing_type& framing, version_type version) {
+    if (framing.has_connection_close) {
+        return connection_type::CLOSE;
+    }
+    if (framing.has_connection_upgrade && framing.has_upgrade) {
+        return connection_type::UPGRADE;
+    }
+    if (framing.has_connection_keep_alive) {
+        return connection_type::KEEP_ALIVE;
+    }
+    return default_connection(version);
+}
+
+} // namespace sl::http::v1
@@ -53,6 +53,7 @@ enum class status_type : std::uint16_t {
     MISDIRECTED_REQUEST = 421,
     UNPROCESSABLE_CONTENT = 422,
     UPGRADE_REQUIRED = 426,
+    REQUEST_HEADER_FIELDS_TOO_LARGE = 431, // RFC 6585
     // SERVER ERROR
     INTERNAL_SERVER_ERROR = 500,
     NOT_IMPLEMENTED = 501,
@@ -142,6 +143,8 @@ constexpr std::string_view enum_to_str(status_type e) {
         return "422";
     case status_type::UPGRADE_REQUIRED:
         return "426";
+    case status_type::REQUEST_HEADER_FIELDS_TOO_LARGE:
+        return "431";
     case status_type::INTERNAL_SERVER_ERROR:
         return "500";
     case status_type::NOT_IMPLEMENTED:
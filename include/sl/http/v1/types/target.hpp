@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -29,18 +30,49 @@ using query_params = std::vector<std::pair<std::string, std::string>>;
 struct origin_target_type {
     std::string path;       // percent-decoded absolute-path
     query_params query;     // decoded query params
+    std::string raw_path;   // path as received if it had escapes, empty otherwise, see router
 };
 
 // absolute-form = absolute-URI
 // e.g.: "http://example.com/path?query"
-// TODO: 
-//   scheme as enum
-//   port as u16
+// authority      = [ userinfo "@" ] host [ ":" port ]
+// host           = IP-literal / IPv4address / reg-name
+enum class scheme_type : std::uint8_t {
+    HTTP,
+    HTTPS,
+    ENUM_END,
+};
+
+constexpr std::string_view enum_to_str(scheme_type e) {
+    switch (e) {
+    case scheme_type::HTTP:
+        return "http";
+    case scheme_type::HTTPS:
+        return "https";
+    default:
+        return {};
+    }
+}
+
+constexpr std::uint16_t default_port(scheme_type e) {
+    switch (e) {
+    case scheme_type::HTTP:
+        return 80;
+    case scheme_type::HTTPS:
+        return 443;
+    default:
+        return 0;
+    }
+}
+
 struct absolute_target_type {
-    std::string scheme;     // "http" or "https"
-    std::string authority;  // host[:port]
+    scheme_type scheme{};
+    std::string userinfo;   // deprecated for http(s), kept for the recipient to reject, never serialized
+    std::string host;       // IP-literal without brackets, reg-name or IPv4 as is
+    std::uint16_t port{};   // 0 means omitted, deserialization fills in default_port(scheme) instead
     std::string path;       // percent-decoded path
     query_params query;
+    std::string raw_path;   // path as received if it had escapes, empty otherwise, see router
 };
 
 // authority-form = host ":" port
@@ -18,616 +18,402 @@
 #include <sl/meta/enum/from_string.hpp>
 #include <sl/meta/match/overloaded.hpp>
 
+#include <algorithm>
 #include <charconv>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace sl::http::v1 {
 
+namespace {
+
+// the builder and the machine share the config, it's kept on the heap so the address survives moves
 meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
-    make_deserialize_request(deserialize_config config) {
-    return [m = detail::deserialize_machine{ std::move(config), /*is_request=*/true }] //
+    make_deserialize_message(deserialize_config config, bool is_request) {
+    auto shared_config = std::make_unique<const deserialize_config>(std::move(config));
+    const deserialize_config& config_ref = *shared_config;
+    return [shared_config = std::move(shared_config),
+            m = detail::deserialize_machine{ detail::message_builder{ config_ref, is_request },
+                                             std::cref(config_ref),
+                                             is_request }] //
         (std::span<const std::byte> input) mutable { return m.deserialize(input); };
 }
 
+} // namespace
+
+meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
+    make_deserialize_request(deserialize_config config) {
+    return make_deserialize_message(std::move(config), /*is_request=*/true);
+}
+
 meta::unique_function<meta::maybe<status_type>(std::span<const std::byte> input)>
     make_deserialize_response(deserialize_config config) {
-    return [m = detail::deserialize_machine{ std::move(config), /*is_request=*/false }] //
-        (std::span<const std::byte> input) mutable { return m.deserialize(input); };
+    return make_deserialize_message(std::move(config), /*is_request=*/false);
 }
 
 namespace detail {
+namespace {
 
-meta::maybe<status_type> deserialize_machine::deserialize(std::span<const std::byte> input) & {
-    if (remainder_.view().empty()) { // less allocations and copying
-        while (!input.empty()) {
-            const auto result = deserialize_impl(input);
-            if (!result.has_value()) {
-                return result.error();
-            }
-            const std::size_t offset = result.value();
-            if (offset == deserialize_ok::continue_token) {
-                continue;
-            }
-            input = input.subspan(offset);
-            if (offset == 0) {
-                break;
-            }
-        }
-    }
-
-    std::ignore = remainder_.merge(input);
-
-    while (true) {
-        const auto result = deserialize_impl(remainder_.view());
-        if (!result.has_value()) {
-            return result.error();
-        }
-        const std::size_t offset = result.value();
-        if (offset == deserialize_ok::continue_token) {
-            continue;
-        }
-        remainder_.add_offset(offset);
-        if (offset == 0) {
-            break;
-        }
+meta::maybe<std::size_t> deserialize_content_length(std::string_view content_length_str) {
+    std::size_t content_length = 0;
+    const auto conv_result = std::from_chars(content_length_str.begin(), content_length_str.end(), content_length);
+    if (conv_result.ec != std::error_code{} || conv_result.ptr != content_length_str.end()) {
+        return meta::null;
     }
+    return content_length;
+}
 
-    return meta::null;
+bool is_framing_field(std::string_view field_key) {
+    return equals_lowercase(field_key, "content-length") || equals_lowercase(field_key, "transfer-encoding")
+           || equals_lowercase(field_key, "connection") || equals_lowercase(field_key, "expect")
+           || equals_lowercase(field_key, "upgrade");
 }
 
-meta::result<std::size_t, status_type> deserialize_machine::deserialize_impl(std::span<const std::byte> input) & {
-    return std::visit([&](const auto& state) { return deserialize_impl(output_, state, config_, input); }, state_)
-        .map([&](deserialize_ok ok) -> std::size_t {
-            state_ = std::move(ok.state);
-
-            if (auto* state = std::get_if<deserialize_state_chunked_body>(&state_)) {
-                if (auto* chunked_state = std::get_if<deserialize_state_chunked_body_complete>(state)) {
-                    config_.chunk_cb(
-                        message_chunk{
-                            .message = output_,
-                            .chunk_ext = std::move(chunked_state->chunk_ext),
-                            .chunk = chunked_state->chunk,
-                        }
-                    );
-                }
+} // namespace
+
+meta::maybe<status_type>
+    deserialize_framing_field(framing_type& framing, std::string_view field_key, std::string_view field_value) {
+    bool is_valid = true;
+
+    if (equals_lowercase(field_key, "content-length")) {
+        // list of identical values is the same as a single value, RFC 9110 8.6
+        bool has_element = false;
+        for_each_list_element(field_value, [&](std::string_view element) {
+            has_element = true;
+            const auto maybe_content_length = deserialize_content_length(element);
+            if (!maybe_content_length.has_value()
+                || (framing.content_length.has_value()
+                    && framing.content_length.value() != maybe_content_length.value())) {
+                is_valid = false;
+                return;
             }
-
-            if (auto* state = std::get_if<deserialize_state_complete>(&state_)) {
-                message_type output;
-                output.start_line = std::visit(
-                    meta::overloaded{
-                        [](const request_line_type&) -> start_line_type { return request_line_type{}; },
-                        [](const response_line_type&) -> start_line_type { return response_line_type{}; },
-                    },
-                    output_.start_line
-                );
-                config_.message_cb(std::exchange(output_, {}));
+            framing.content_length = maybe_content_length.value();
+        });
+        is_valid = is_valid && has_element && !framing.has_transfer_encoding;
+    } else if (equals_lowercase(field_key, "transfer-encoding")) {
+        for_each_list_element(field_value, [&](std::string_view element) {
+            // chunked must be the final coding and must not be applied twice
+            is_valid = is_valid && !framing.is_chunked;
+            const auto coding = strip_suffix_while(element.substr(0, element.find(';')), tokens::is_ws);
+            framing.is_chunked = equals_lowercase(coding, "chunked");
+            framing.has_transfer_encoding = true;
+        });
+        is_valid = is_valid && !framing.content_length.has_value();
+    } else if (equals_lowercase(field_key, "connection")) {
+        for_each_list_element(field_value, [&framing](std::string_view option) {
+            framing.has_connection_close |= equals_lowercase(option, "close");
+            framing.has_connection_keep_alive |= equals_lowercase(option, "keep-alive");
+            framing.has_connection_upgrade |= equals_lowercase(option, "upgrade");
+        });
+    } else if (equals_lowercase(field_key, "expect")) {
+        for_each_list_element(field_value, [&framing](std::string_view expectation) {
+            if (framing.expect != expect_type::UNKNOWN && equals_lowercase(expectation, "100-continue")) {
+                framing.expect = expect_type::CONTINUE;
+            } else {
+                framing.expect = expect_type::UNKNOWN;
             }
-
-            return ok.offset;
         });
-}
+    } else if (equals_lowercase(field_key, "upgrade")) {
+        framing.has_upgrade = true;
+    }
 
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    return std::visit([&](const auto& a_state) { return deserialize_impl(output, a_state, config, input); }, state);
+    if (!is_valid) {
+        return status_type::BAD_REQUEST;
+    }
+    return meta::null;
 }
 
-// method SP request-target SP HTTP-version CRLF
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_request state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    DEBUG_ASSERT(std::holds_alternative<request_line_type>(output.start_line));
-    return std::visit([&](const auto& a_state) { return deserialize_impl(output, a_state, config, input); }, state);
+bool is_field_retained(const meta::maybe<field_names_type>& retained_fields, std::string_view field_key) {
+    return !retained_fields.has_value() || retained_fields.value().contains(field_key) || is_framing_field(field_key);
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_request_method state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
+
+void append_field(
+    fields_type& fields,
+    std::string_view field_key,
+    std::string_view lowercase_key,
+    std::string_view field_value,
+    bool is_name_trusted
 ) {
-    const auto input_str = buffer_byte_to_str(input);
-    constexpr std::size_t method_max_length = enum_max_str_length<method_type>();
-
-    const auto method_result = try_find(input_str, tokens::SP, method_max_length);
-    if (!method_result.has_value()) {
-        const auto& method_err = method_result.error();
-        if (method_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::NOT_IMPLEMENTED);
-        }
-        DEBUG_ASSERT(method_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
+    std::string lowercase_string;
+    if (lowercase_key.empty()) {
+        lowercase_string = to_lowercase(field_key);
+        lowercase_key = lowercase_string;
     }
 
-    const auto& [method_str, method_offset] = method_result.value();
-    const auto method = meta::enum_from_str<method_type>(method_str);
-    if (method == method_type::ENUM_END) {
-        return meta::err(status_type::BAD_REQUEST);
+    field_name name = is_name_trusted ? field_name::interned(lowercase_key) : field_name{ lowercase_key };
+    const auto [field_kv_it, field_kv_is_emplaced] = fields.try_emplace(std::move(name), std::string{ field_value });
+    if (!field_kv_is_emplaced) {
+        field_kv_it.value() += ", ";
+        field_kv_it.value() += field_value;
     }
-
-    std::get<request_line_type>(output.start_line).method = method;
-    return deserialize_ok{
-        .state = deserialize_state_start_line_request{ deserialize_state_start_line_request_target{} },
-        .offset = method_offset,
-    };
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_request_target state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    const auto target_result = try_find(input_str, tokens::SP, config.max_target_size);
-    if (!target_result.has_value()) {
-        const auto& target_err = target_result.error();
-        if (target_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::URI_TOO_LONG);
-        }
-        DEBUG_ASSERT(target_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
-    }
-    const auto& [target_str, target_offset] = target_result.value();
 
-    auto maybe_target = deserialize_target(target_str);
-    if (!maybe_target.has_value()) {
-        return meta::err(status_type::BAD_REQUEST);
-    }
+namespace {
 
-    std::get<request_line_type>(output.start_line).target = std::move(maybe_target).value();
-    return deserialize_ok{
-        .state = deserialize_state_start_line_request{ deserialize_state_start_line_request_version{} },
-        .offset = target_offset,
-    };
-}
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
+meta::maybe<status_type> apply_parse_event(
     message_type& output,
-    deserialize_state_start_line_request_version state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
+    const deserialize_event& event,
+    const deserialize_context& context,
+    const deserialize_config& config
 ) {
-    const auto input_str = buffer_byte_to_str(input);
-    constexpr std::size_t version_max_length = enum_max_str_length<version_type>();
-    const auto version_result = try_find(input_str, tokens::CRLF, version_max_length);
-    if (!version_result.has_value()) {
-        const auto& version_err = version_result.error();
-        if (version_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::BAD_REQUEST);
-        }
-        DEBUG_ASSERT(version_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
-    }
+    return std::visit(
+        meta::overloaded{
+            [](const auto&) -> meta::maybe<status_type> { return meta::null; },
+            [&output](const deserialize_event_method& e) -> meta::maybe<status_type> {
+                std::get<request_line_type>(output.start_line).method = e.method;
+                return meta::null;
+            },
+            [&output](const deserialize_event_target& e) -> meta::maybe<status_type> {
+                auto maybe_target = deserialize_target(e.target);
+                if (!maybe_target.has_value()) {
+                    return status_type::BAD_REQUEST;
+                }
+                std::get<request_line_type>(output.start_line).target = std::move(maybe_target).value();
+                return meta::null;
+            },
+            [&output](const deserialize_event_version& e) -> meta::maybe<status_type> {
+                std::visit([&e](auto& start_line) { start_line.version = e.version; }, output.start_line);
+                return meta::null;
+            },
+            [&output](const deserialize_event_status& e) -> meta::maybe<status_type> {
+                std::get<response_line_type>(output.start_line).status = e.status;
+                return meta::null;
+            },
+            [&output](const deserialize_event_reason& e) -> meta::maybe<status_type> {
+                std::get<response_line_type>(output.start_line).reason = e.reason;
+                return meta::null;
+            },
+            [&output, &config](const deserialize_event_field& e) -> meta::maybe<status_type> {
+                if (is_field_retained(config.retained_fields, e.name)) {
+                    append_field(output.fields, e.name, e.lowercase_name, e.value, config.retained_fields.has_value());
+                }
+                return meta::null;
+            },
+            [&output, &config](const deserialize_event_trailer& e) -> meta::maybe<status_type> {
+                if (is_field_retained(config.retained_fields, e.name)) {
+                    append_field(output.fields, e.name, e.lowercase_name, e.value, config.retained_fields.has_value());
+                }
+                return meta::null;
+            },
+            [&output, &context](const deserialize_event_headers&) -> meta::maybe<status_type> {
+                output.framing = context.framing;
+                return meta::null;
+            },
+            [&output](const deserialize_event_body& e) -> meta::maybe<status_type> {
+                output.body.insert(output.body.end(), e.body.begin(), e.body.end());
+                return meta::null;
+            },
+        },
+        event
+    );
+}
 
-    const auto& [version_str, version_offset] = version_result.value();
-    const auto version = meta::enum_from_str<version_type>(version_str);
-    if (version == version_type::ENUM_END) {
-        return meta::err(status_type::BAD_REQUEST);
+meta::result<parse_ok, status_type>
+    parse_message(std::span<const std::byte> input, const deserialize_config& config, bool is_request) {
+    deserialize_context context{ .is_request = is_request };
+    deserialize_state state = deserialize_core::initial_state(is_request);
+    parse_ok result{ .message = {}, .offset = 0 };
+    if (is_request) {
+        result.message.start_line = request_line_type{};
+    } else {
+        result.message.start_line = response_line_type{};
     }
 
-    std::get<request_line_type>(output.start_line).version = version;
-    return deserialize_ok{
-        .state = deserialize_state_fields{},
-        .offset = version_offset,
-    };
-}
-
-// HTTP-version SP status-code SP [ reason-phrase ] CRLF
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_response state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    DEBUG_ASSERT(std::holds_alternative<response_line_type>(output.start_line));
-    return std::visit([&](const auto& a_state) { return deserialize_impl(output, a_state, config, input); }, state);
-}
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_response_version state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    constexpr std::size_t version_max_length = enum_max_str_length<version_type>();
-    const auto version_result = try_find(input_str, tokens::SP, version_max_length);
-    if (!version_result.has_value()) {
-        const auto& version_err = version_result.error();
-        if (version_err == find_err::MAX_SIZE_EXCEEDED) {
+    while (true) {
+        auto step_result = deserialize_core::deserialize_step(context, state, config, input.subspan(result.offset));
+        if (!step_result.has_value()) {
+            return meta::err(step_result.error());
+        }
+        auto& ok = step_result.value();
+        if (std::holds_alternative<deserialize_event_complete>(ok.event)) {
+            return result;
+        }
+        if (ok.offset == 0) { // the message is incomplete
             return meta::err(status_type::BAD_REQUEST);
         }
-        DEBUG_ASSERT(version_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
+        if (const auto maybe_error = apply_parse_event(result.message, ok.event, context, config);
+            maybe_error.has_value()) {
+            return meta::err(maybe_error.value());
+        }
+        state = ok.state;
+        if (ok.offset != deserialize_ok::continue_token) {
+            result.offset += ok.offset;
+        }
     }
+}
 
-    const auto& [version_str, version_offset] = version_result.value();
-    const auto version = meta::enum_from_str<version_type>(version_str);
-    if (version == version_type::ENUM_END) {
-        return meta::err(status_type::BAD_REQUEST);
-    }
+} // namespace
 
-    std::get<response_line_type>(output.start_line).version = version;
-    return deserialize_ok{
-        .state = deserialize_state_start_line_response{ deserialize_state_start_line_response_status{} },
-        .offset = version_offset,
-    };
+const deserialize_config& default_parse_config() {
+    static const deserialize_config config{};
+    return config;
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_response_status state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    constexpr std::size_t status_code_length = 3;
 
-    const auto status_result = try_find(input_str, tokens::SP, status_code_length);
-    if (!status_result.has_value()) {
-        const auto& status_err = status_result.error();
-        if (status_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::BAD_REQUEST);
-        }
-        DEBUG_ASSERT(status_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
-    }
+message_builder::message_builder(const deserialize_config& config, bool is_request)
+    : config_{ config }, is_request_{ is_request } {
+    DEBUG_ASSERT(!!config.message_cb);
+    reset();
+}
 
-    const auto& [status_str, status_offset] = status_result.value();
-    if (status_str.size() != status_code_length) {
-        return meta::err(status_type::BAD_REQUEST);
-    }
+meta::maybe<status_type> message_builder::on_method(method_type method) {
+    std::get<request_line_type>(output_.start_line).method = method;
+    return meta::null;
+}
 
-    std::uint16_t status_code = 0;
-    const auto conv_result = std::from_chars(status_str.begin(), status_str.end(), status_code);
-    if (conv_result.ec != std::error_code{} || conv_result.ptr != status_str.end()) {
-        return meta::err(status_type::BAD_REQUEST);
+meta::maybe<status_type> message_builder::on_target(std::string_view target) {
+    auto maybe_target = deserialize_target(target);
+    if (!maybe_target.has_value()) {
+        return status_type::BAD_REQUEST;
     }
-
-    std::get<response_line_type>(output.start_line).status = static_cast<status_type>(status_code);
-    return deserialize_ok{
-        .state = deserialize_state_start_line_response{ deserialize_state_start_line_response_reason{} },
-        .offset = status_offset,
-    };
+    std::get<request_line_type>(output_.start_line).target = std::move(maybe_target).value();
+    return meta::null;
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_start_line_response_reason state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    const auto reason_result = try_find(input_str, tokens::CRLF, config.max_reason_size);
-    if (!reason_result.has_value()) {
-        const auto& reason_err = reason_result.error();
-        if (reason_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::BAD_REQUEST);
-        }
-        DEBUG_ASSERT(reason_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(state);
-    }
 
-    const auto& [reason_str, reason_offset] = reason_result.value();
-    std::get<response_line_type>(output.start_line).reason = reason_str;
-    return deserialize_ok{
-        .state = deserialize_state_fields{},
-        .offset = reason_offset,
-    };
+meta::maybe<status_type> message_builder::on_version(version_type version) {
+    std::visit([version](auto& start_line) { start_line.version = version; }, output_.start_line);
+    return meta::null;
 }
 
-// *( field-line CRLF ) CRLF
-// field-line   = field-name ":" OWS field-value OWS
-// OWS = *(SP / HTAB)
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_fields state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    return deserialize_impl(
-        output, std::variant<deserialize_state_fields, deserialize_state_trailing_fields>(state), config, input
-    );
+meta::maybe<status_type> message_builder::on_status(status_type status) {
+    std::get<response_line_type>(output_.start_line).status = status;
+    return meta::null;
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_trailing_fields state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    return deserialize_impl(
-        output, std::variant<deserialize_state_fields, deserialize_state_trailing_fields>(state), config, input
-    );
+
+meta::maybe<status_type> message_builder::on_reason(std::string_view reason) {
+    std::get<response_line_type>(output_.start_line).reason = reason;
+    return meta::null;
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    std::variant<deserialize_state_fields, deserialize_state_trailing_fields> state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    const std::size_t consumed_bytes = std::visit([](const auto& s) { return s.consumed_bytes; }, state);
-    const auto field_line_result = try_find(input_str, tokens::CRLF, config.max_field_size - consumed_bytes);
-    if (!field_line_result.has_value()) {
-        const auto& field_line_err = field_line_result.error();
-        if (field_line_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::CONTENT_TOO_LARGE);
-        }
-        DEBUG_ASSERT(field_line_err == find_err::NOT_FOUND);
-        return std::visit([](auto s) { return deserialize_ok::stop(s); }, state);
-    }
-    const auto& [field_line, field_line_offset] = field_line_result.value();
-    std::visit([field_line_offset](auto& s) { s.consumed_bytes += field_line_offset; }, state);
 
-    if (!field_line.empty()) {
-        // not limiting by max_size since field_line_result is already limited
-        const auto field_kv_result = try_find_unlimited(field_line, ":");
-        if (!field_kv_result.has_value()) {
-            return meta::err(status_type::BAD_REQUEST);
-        }
-        const auto& [field_key, field_offset] = field_kv_result.value();
-        constexpr auto strip = [](std::string_view x) {
-            x = strip_prefix_while(x, tokens::is_ws);
-            x = strip_suffix_while(x, tokens::is_ws);
-            return x;
-        };
-        const auto field_value = strip(field_line.substr(field_offset));
-
-        const auto field_key_lower = to_lowercase(field_key);
-        const auto [field_kv_it, field_kv_is_emplaced] =
-            output.fields.try_emplace(field_key_lower, std::string{ field_value });
-        if (!field_kv_is_emplaced) {
-            field_kv_it.value() += ", ";
-            field_kv_it.value() += field_value;
-        }
+meta::maybe<status_type> message_builder::on_field(const deserialize_event_field& field) {
+    const auto& retained_fields = config_.get().retained_fields;
+    if (is_field_retained(retained_fields, field.name)) {
+        append_field(output_.fields, field.name, field.lowercase_name, field.value, retained_fields.has_value());
+    }
+    return meta::null;
+}
 
-        return std::visit(
-            [field_line_offset](auto s) {
-                return deserialize_ok{
-                    .state = s,
-                    .offset = field_line_offset,
-                };
-            },
-            state
-        );
+meta::maybe<status_type> message_builder::on_headers(const framing_type& framing) {
+    output_.framing = framing;
+    auto mode_result = config_.get().headers_cb(output_);
+    if (!mode_result.has_value()) {
+        return mode_result.error();
     }
+    body_mode_ = mode_result.value();
+    return meta::null;
+}
 
-    // detected last CRLF
-    DEBUG_ASSERT(field_line.empty());
+meta::maybe<status_type> message_builder::on_expect() { return config_.get().expect_cb(output_); }
 
-    return std::visit(
-        meta::overloaded{
-            [&](deserialize_state_fields) {
-                return deserialize_state_fields_finalize(output, config).map([field_line_offset](deserialize_state s) {
-                    return deserialize_ok{ .state = s, .offset = field_line_offset };
-                });
-            },
-            [field_line_offset](deserialize_state_trailing_fields) -> meta::result<deserialize_ok, status_type> {
-                return deserialize_ok{ .state = deserialize_state_complete{}, .offset = field_line_offset };
-            },
-        },
-        state
-    );
+meta::maybe<status_type> message_builder::on_chunk_ext(std::string_view chunk_ext) {
+    if (!chunk_ext.empty()) { // chunks with extensions are never merged
+        flush_coalesced_chunk();
+    }
+    chunk_ext_.assign(chunk_ext);
+    return meta::null;
 }
-meta::result<deserialize_state, status_type>
-    deserialize_machine::deserialize_state_fields_finalize(message_type& output, const deserialize_config& config) {
-    const auto find_field = [&fields = output.fields](std::string_view k) -> meta::maybe<std::string_view> {
-        DEBUG_ASSERT(is_lowercase(k));
-        auto it = fields.find(k);
-        if (it == fields.end()) {
-            return meta::null;
-        }
-        return std::string_view{ it.value() };
-    };
-    constexpr auto check_chunked_field = [](std::string_view transfer_encodings) {
-        constexpr std::string_view needle = "chunked";
-        const auto strip_ws = [](std::string_view s) {
-            return strip_suffix_while(strip_prefix_while(s, tokens::is_ws), tokens::is_ws);
-        };
-        transfer_encodings = strip_ws(transfer_encodings);
-        while (transfer_encodings.size() >= needle.size()) {
-            const auto result = try_find_split_unlimited(transfer_encodings, ",");
-            if (strip_ws(result.head) == needle) {
-                return true;
+
+meta::maybe<status_type> message_builder::on_body(std::span<const std::byte> body) {
+    if (body_mode_ == body_mode::DISCARD) {
+        return meta::null;
+    }
+    if (output_.framing.is_chunked) {
+        const std::size_t coalesced_chunk_size = config_.get().coalesced_chunk_size;
+        if (coalesced_chunk_size > 0 && chunk_ext_.empty() && !body.empty()) {
+            if (coalesced_chunk_.size() + body.size() > coalesced_chunk_size) {
+                flush_coalesced_chunk();
             }
-            if (!result.tail.has_value()) {
-                break;
+            if (body.size() < coalesced_chunk_size) {
+                coalesced_chunk_.insert(coalesced_chunk_.end(), body.begin(), body.end());
+                return meta::null;
             }
-            transfer_encodings = strip_ws(result.tail.value());
-        }
-        return false;
-    };
-    constexpr auto deserialize_content_length = [](std::string_view content_length_str) -> meta::maybe<std::size_t> {
-        std::size_t content_length = 0;
-        const auto conv_result = std::from_chars(content_length_str.begin(), content_length_str.end(), content_length);
-        if (conv_result.ec != std::error_code{} || conv_result.ptr != content_length_str.end()) {
-            return meta::null;
-        }
-        return content_length;
-    };
-
-    const auto maybe_transfer_encodings = find_field("transfer-encoding");
-    const auto maybe_content_length_str = find_field("content-length");
-    const bool is_chunked = maybe_transfer_encodings.map(check_chunked_field).value_or(false);
-
-    if (is_chunked) {
-        if (maybe_content_length_str.has_value()) {
-            // TODO: or is it?
-            return meta::err(status_type::BAD_REQUEST);
         }
-        return deserialize_state_chunked_body{ deserialize_state_chunked_body_empty{} };
-    }
-
-    const auto maybe_content_length = maybe_content_length_str.and_then(deserialize_content_length);
-    const auto content_length = maybe_content_length.value_or(0);
-    if (content_length == 0) {
-        return deserialize_state_complete{};
+        flush_coalesced_chunk(); // keeps the order, the last-chunk included
+        config_.get().chunk_cb(message_chunk{ .message = output_, .chunk_ext = chunk_ext_, .chunk = body });
+        chunk_ext_.clear();
+    } else if (body_mode_ == body_mode::BUFFER) {
+        return buffer_body(body);
+    } else {
+        config_.get().chunk_cb(message_chunk{ .message = output_, .chunk_ext = {}, .chunk = body });
     }
+    return meta::null;
+}
 
-    if (content_length > config.max_body_size) {
-        return meta::err(status_type::CONTENT_TOO_LARGE);
+meta::maybe<status_type> message_builder::on_trailer(const deserialize_event_trailer& trailer) {
+    const auto& retained_fields = config_.get().retained_fields;
+    if (is_field_retained(retained_fields, trailer.name)) {
+        append_field(output_.fields, trailer.name, trailer.lowercase_name, trailer.value, retained_fields.has_value());
     }
-
-    return deserialize_state_body{ .content_length = content_length };
+    return meta::null;
 }
 
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_body state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    DEBUG_ASSERT(state.content_length > output.body.size());
+meta::maybe<status_type> message_builder::on_input_end() {
+    flush_coalesced_chunk();
+    return meta::null;
+}
 
-    const std::size_t content_length_left = state.content_length - output.body.size();
-    const std::size_t limited_byte_buffer_size = std::min(content_length_left, input.size());
-    const auto limited_byte_buffer = input.subspan(0, limited_byte_buffer_size);
-    output.body.insert(output.body.end(), limited_byte_buffer.begin(), limited_byte_buffer.end());
+meta::maybe<status_type> message_builder::on_complete() {
+    config_.get().message_cb(std::exchange(output_, {}));
+    reset();
+    return meta::null;
+}
 
-    if (output.body.size() < state.content_length) {
-        return deserialize_ok{ .state = state, .offset = limited_byte_buffer_size };
+void message_builder::flush_coalesced_chunk() {
+    if (coalesced_chunk_.empty()) {
+        return;
     }
-
-    DEBUG_ASSERT(output.body.size() == state.content_length);
-    return deserialize_ok{ .state = deserialize_state_complete{}, .offset = limited_byte_buffer_size };
+    config_.get().chunk_cb(message_chunk{ .message = output_, .chunk_ext = {}, .chunk = coalesced_chunk_ });
+    coalesced_chunk_.clear();
 }
 
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_chunked_body state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    return std::visit([&](const auto& a_state) { return deserialize_impl(output, a_state, config, input); }, state);
-}
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_chunked_body_empty state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const auto input_str = buffer_byte_to_str(input);
-    const auto chunk_line_result = try_find(input_str, tokens::CRLF, config.max_chunk_line_size);
-    if (!chunk_line_result.has_value()) {
-        const auto chunk_line_err = chunk_line_result.error();
-        if (chunk_line_err == find_err::MAX_SIZE_EXCEEDED) {
-            return meta::err(status_type::BAD_REQUEST);
+meta::maybe<status_type> message_builder::buffer_body(std::span<const std::byte> body) {
+    if (!output_.body_file.has_value() && output_.body.size() + body.size() > config_.get().body_spill_size) {
+        auto file_result = body_file_type::create(config_.get().body_spill_directory);
+        if (!file_result.has_value() || file_result.value().append(output_.body)) {
+            return status_type::INTERNAL_SERVER_ERROR;
         }
-        DEBUG_ASSERT(chunk_line_err == find_err::NOT_FOUND);
-        return deserialize_ok::stop(deserialize_state_chunked_body{ state });
+        output_.body_file = std::move(file_result).value();
+        output_.body = {}; // the memory goes with it
     }
-    const auto& chunk_line_ok = chunk_line_result.value();
-
-    const auto split_result = try_find_split_unlimited(chunk_line_ok.value, ";");
-
-    const auto chunk_size_str = strip_suffix_while(split_result.head, tokens::is_ws); // BWS
-    if (chunk_size_str.size() > config.max_chunk_size_size) {
-        return meta::err(status_type::BAD_REQUEST);
-    }
-    const auto maybe_chunk_size = [chunk_size_str]() -> meta::maybe<std::uint32_t> {
-        std::uint32_t chunk_size = 0;
-        const auto conv_result = std::from_chars(chunk_size_str.begin(), chunk_size_str.end(), chunk_size, 16);
-        if (conv_result.ec != std::error_code{} || conv_result.ptr != chunk_size_str.end()) {
-            return meta::null;
+    if (output_.body_file.has_value()) {
+        if (output_.body_file.value().append(body)) {
+            return status_type::INTERNAL_SERVER_ERROR;
         }
-        return chunk_size;
-    }();
-    if (!maybe_chunk_size.has_value()) {
-        return meta::err(status_type::BAD_REQUEST);
-    }
-    const std::uint32_t chunk_size = maybe_chunk_size.value();
-
-    const auto chunk_ext = split_result //
-                               .tail
-                               .map([](std::string_view x) { return strip_prefix_while(x, tokens::is_ws); }) // BWS
-                               .value_or(std::string_view{});
-
-    if (chunk_size == 0) { // last-chunk
-        return deserialize_ok{
-            .state = deserialize_state_chunked_body{ deserialize_state_chunked_body_complete{
-                .chunk_ext{ chunk_ext },
-                .chunk{},
-            } },
-            .offset = chunk_line_ok.offset,
-        };
+        return meta::null;
     }
-
-    return deserialize_ok{
-        .state = deserialize_state_chunked_body{ deserialize_state_chunked_body_line{
-            .chunk_ext{ chunk_ext },
-            .chunk_size = chunk_size,
-        } },
-        .offset = chunk_line_ok.offset,
-    };
+    output_.body.insert(output_.body.end(), body.begin(), body.end());
+    return meta::null;
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_chunked_body_line state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    const std::uint32_t chunk_size = state.chunk_size;
-    const std::size_t offset = chunk_size + tokens::CRLF.size();
-    if (input.size() < offset) {
-        return deserialize_ok::stop(deserialize_state_chunked_body{ state });
-    }
 
-    if (const std::string_view crlf_expected = buffer_byte_to_str(input.subspan(chunk_size, tokens::CRLF.size()));
-        crlf_expected != tokens::CRLF) {
-        return meta::err(status_type::BAD_REQUEST);
+void message_builder::reset() {
+    if (is_request_) {
+        output_.start_line = request_line_type{};
+    } else {
+        output_.start_line = response_line_type{};
     }
+    chunk_ext_.clear();
+    coalesced_chunk_.clear();
+    body_mode_ = body_mode::BUFFER;
+}
+
+} // namespace detail
 
-    return deserialize_ok{
-        .state = deserialize_state_chunked_body{ deserialize_state_chunked_body_complete{
-            .chunk_ext = std::move(state.chunk_ext),
-            .chunk = input.subspan(0, chunk_size),
-        } },
-        .offset = offset,
-    };
+meta::result<parse_ok, status_type> parse_request(std::span<const std::byte> input) {
+    return detail::parse_message(input, detail::default_parse_config(), /*is_request=*/true);
 }
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_chunked_body_complete state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    if (state.chunk.empty()) { // detected last-chunk
-        return deserialize_ok{
-            .state = deserialize_state_trailing_fields{},
-            .offset = deserialize_ok::continue_token,
-        };
-    } else {
-        return deserialize_ok{
-            .state = deserialize_state_chunked_body{ deserialize_state_chunked_body_empty{} },
-            .offset = deserialize_ok::continue_token,
-        };
-    }
+
+meta::result<parse_ok, status_type> parse_request(std::span<const std::byte> input, const deserialize_config& config) {
+    return detail::parse_message(input, config, /*is_request=*/true);
 }
 
-meta::result<deserialize_ok, status_type> deserialize_machine::deserialize_impl(
-    message_type& output,
-    deserialize_state_complete state,
-    const deserialize_config& config,
-    std::span<const std::byte> input
-) {
-    return deserialize_ok{
-        .state = std::visit(
-            meta::overloaded{
-                [](const request_line_type&) {
-                    return deserialize_state_start_line{ deserialize_state_start_line_request{} };
-                },
-                [](const response_line_type&) {
-                    return deserialize_state_start_line{ deserialize_state_start_line_response{} };
-                },
-            },
-            output.start_line
-        ),
-        .offset = deserialize_ok::continue_token,
-    };
+meta::result<parse_ok, status_type> parse_response(std::span<const std::byte> input) {
+    return detail::parse_message(input, detail::default_parse_config(), /*is_request=*/false);
+}
+
+meta::result<parse_ok, status_type> parse_response(std::span<const std::byte> input, const deserialize_config& config) {
+    return detail::parse_message(input, config, /*is_request=*/false);
 }
 
-} // namespace detail
 } // namespace sl::http::v1
@@ -0,0 +1,231 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/packed.hpp"
+
+#include "sl/http/v1/detail/strings.hpp"
+
+#include <sl/meta/assert.hpp>
+#include <sl/meta/match/overloaded.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <variant>
+
+namespace sl::http::v1 {
+namespace {
+
+// everything in the buffer comes from the input, the decoded path is at most as long as the target
+constexpr std::size_t max_packed_input_size = std::numeric_limits<std::uint32_t>::max() / 2;
+
+packed_span make_packed_span(std::size_t offset, std::size_t size) {
+    return packed_span{ .offset = static_cast<std::uint32_t>(offset), .size = static_cast<std::uint32_t>(size) };
+}
+
+} // namespace
+
+meta::maybe<origin_target_view> packed_message::origin_target() const {
+    if (!is_origin_form_) {
+        return meta::null;
+    }
+    return origin_target_view{ .path = view(path_), .query = query_view{ view(query_) } };
+}
+
+meta::maybe<std::string_view> packed_message::find_field(std::string_view lowercase_name) const {
+    for (const packed_field& field : fields_) {
+        if (detail::equals_lowercase(view(field.name), lowercase_name)) {
+            return view(field.value);
+        }
+    }
+    return meta::null;
+}
+
+std::span<const std::byte> packed_message::body() const { return detail::buffer_str_to_byte(view(body_)); }
+
+message_type packed_message::to_message() const {
+    message_type message;
+    for (const packed_field& field : fields_) {
+        detail::append_field(message.fields, view(field.name), {}, view(field.value), /*is_name_trusted=*/false);
+    }
+    const auto body_bytes = body();
+    message.body.assign(body_bytes.begin(), body_bytes.end());
+    if (is_request_) {
+        auto maybe_target = deserialize_target(raw_target());
+        DEBUG_ASSERT(maybe_target.has_value()); // validated by parse
+        message.start_line = request_line_type{
+            .target = std::move(maybe_target).value(),
+            .method = method_,
+            .version = version_,
+        };
+    } else {
+        message.start_line = response_line_type{
+            .reason = std::string{ reason() },
+            .status = status_,
+            .version = version_,
+        };
+    }
+    message.framing = framing_;
+    return message;
+}
+
+meta::result<meta::maybe<packed_parse_ok>, status_type>
+    packed_message::parse(std::span<const std::byte> input, const deserialize_config& config, bool is_request) {
+    if (input.size() > max_packed_input_size) {
+        return meta::err(status_type::CONTENT_TOO_LARGE);
+    }
+    const char* const input_begin = detail::buffer_byte_to_str(input).data();
+    const auto head_span = [input_begin](std::string_view x) {
+        return make_packed_span(static_cast<std::size_t>(x.data() - input_begin), x.size());
+    };
+    const auto append_span = [](std::string& buffer, std::string_view x) {
+        const std::size_t offset = buffer.size();
+        buffer.append(x);
+        return make_packed_span(offset, x.size());
+    };
+
+    detail::deserialize_context context{ .is_request = is_request };
+    detail::deserialize_state state = detail::deserialize_core::initial_state(is_request);
+    packed_parse_ok result{ .message = {}, .offset = 0 };
+    packed_message& message = result.message;
+    message.is_request_ = is_request;
+
+    // head events point into input, which becomes the front of the buffer once the head is over
+    const auto apply_event = [&](const detail::deserialize_event& event) -> meta::maybe<status_type> {
+        return std::visit(
+            meta::overloaded{
+                [](const auto&) -> meta::maybe<status_type> { return meta::null; },
+                [&message](const detail::deserialize_event_method& e) -> meta::maybe<status_type> {
+                    message.method_ = e.method;
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_target& e) -> meta::maybe<status_type> {
+                    message.target_ = head_span(e.target);
+                    return meta::null;
+                },
+                [&message](const detail::deserialize_event_version& e) -> meta::maybe<status_type> {
+                    message.version_ = e.version;
+                    return meta::null;
+                },
+                [&message](const detail::deserialize_event_status& e) -> meta::maybe<status_type> {
+                    message.status_ = e.status;
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_reason& e) -> meta::maybe<status_type> {
+                    message.reason_ = head_span(e.reason);
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_field& e) -> meta::maybe<status_type> {
+                    if (detail::is_field_retained(config.retained_fields, e.name)) {
+                        message.fields_.push_back(packed_field{
+                            .name = head_span(e.name),
+                            .value = head_span(e.value),
+                        });
+                    }
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_headers&) -> meta::maybe<status_type> {
+                    message.framing_ = context.framing;
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_body& e) -> meta::maybe<status_type> {
+                    message.buffer_.append(detail::buffer_byte_to_str(e.body));
+                    message.body_.size += static_cast<std::uint32_t>(e.body.size());
+                    return meta::null;
+                },
+                [&](const detail::deserialize_event_trailer& e) -> meta::maybe<status_type> {
+                    if (detail::is_field_retained(config.retained_fields, e.name)) {
+                        const packed_span name = append_span(message.buffer_, e.name);
+                        const packed_span value = append_span(message.buffer_, e.value);
+                        message.fields_.push_back(packed_field{ .name = name, .value = value });
+                    }
+                    return meta::null;
+                },
+            },
+            event
+        );
+    };
+
+    // copies the head and decodes the target behind it, the body follows
+    const auto finish_head = [&](std::size_t head_size) -> meta::maybe<status_type> {
+        // reserved up front, the target is appended from a view into the buffer
+        const std::size_t body_size_hint =
+            std::min(message.framing_.content_length.value_or(0), input.size() - head_size);
+        message.buffer_.reserve(head_size + message.target_.size + body_size_hint);
+        message.buffer_.assign(detail::buffer_byte_to_str(input.first(head_size)));
+        message.head_ = make_packed_span(0, head_size);
+        if (is_request) {
+            const std::string_view raw_target = message.raw_target();
+            if (raw_target.starts_with('/')) {
+                const std::size_t target_offset = message.buffer_.size();
+                message.buffer_.append(raw_target);
+                const auto maybe_origin = detail::deserialize_origin_form_in_place(
+                    std::span{ message.buffer_ }.subspan(target_offset)
+                );
+                if (!maybe_origin.has_value()) {
+                    return status_type::BAD_REQUEST;
+                }
+                const auto& origin = maybe_origin.value();
+                message.path_ = make_packed_span(target_offset, origin.path.size());
+                if (const std::string_view query = origin.query.raw(); !query.empty()) {
+                    message.query_ = make_packed_span(
+                        static_cast<std::size_t>(query.data() - message.buffer_.data()), query.size()
+                    );
+                }
+                message.is_origin_form_ = true;
+            } else if (!deserialize_target(raw_target).has_value()) {
+                return status_type::BAD_REQUEST;
+            }
+        }
+        message.body_ = make_packed_span(message.buffer_.size(), 0);
+        return meta::null;
+    };
+
+    while (true) {
+        auto step_result =
+            detail::deserialize_core::deserialize_step(context, state, config, input.subspan(result.offset));
+        if (!step_result.has_value()) {
+            return meta::err(step_result.error());
+        }
+        auto& ok = step_result.value();
+        if (std::holds_alternative<detail::deserialize_event_complete>(ok.event)) {
+            return meta::maybe<packed_parse_ok>{ std::move(result) };
+        }
+        if (ok.offset == 0) { // the message is incomplete
+            return meta::maybe<packed_parse_ok>{};
+        }
+        if (const auto maybe_error = apply_event(ok.event); maybe_error.has_value()) {
+            return meta::err(maybe_error.value());
+        }
+        state = ok.state;
+        if (ok.offset != detail::deserialize_ok::continue_token) {
+            result.offset += ok.offset;
+        }
+        if (std::holds_alternative<detail::deserialize_event_headers>(ok.event)) {
+            if (const auto maybe_error = finish_head(result.offset); maybe_error.has_value()) {
+                return meta::err(maybe_error.value());
+            }
+        }
+    }
+}
+
+meta::result<meta::maybe<packed_parse_ok>, status_type> parse_packed_request(std::span<const std::byte> input) {
+    return packed_message::parse(input, detail::default_parse_config(), /*is_request=*/true);
+}
+
+meta::result<meta::maybe<packed_parse_ok>, status_type>
+    parse_packed_request(std::span<const std::byte> input, const deserialize_config& config) {
+    return packed_message::parse(input, config, /*is_request=*/true);
+}
+
+meta::result<meta::maybe<packed_parse_ok>, status_type> parse_packed_response(std::span<const std::byte> input) {
+    return packed_message::parse(input, detail::default_parse_config(), /*is_request=*/false);
+}
+
+meta::result<meta::maybe<packed_parse_ok>, status_type>
+    parse_packed_response(std::span<const std::byte> input, const deserialize_config& config) {
+    return packed_message::parse(input, config, /*is_request=*/false);
+}
+
+} // namespace sl::http::v1
@@ -0,0 +1,129 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/query.hpp"
+#include "sl/http/v1/deserialize/target.hpp"
+#include "sl/http/v1/detail/strings.hpp"
+
+#include <algorithm>
+
+namespace sl::http::v1 {
+
+namespace {
+
+bool is_encoded(std::string_view raw) { return detail::find_first_of(raw, '%', '+') != std::string_view::npos; }
+
+// Compares while decoding, malformed `raw` equals nothing
+bool decoded_equals(std::string_view raw, std::string_view key) {
+    if (!is_encoded(raw)) {
+        return raw == key;
+    }
+    while (!raw.empty()) {
+        char c = raw.front();
+        std::size_t raw_size = 1;
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%') {
+            if (raw.size() < 3) {
+                return false;
+            }
+            const auto maybe_char = detail::percent_decode::byte(raw[1], raw[2]);
+            if (!maybe_char.has_value()) {
+                return false;
+            }
+            c = maybe_char.value();
+            raw_size = 3;
+        }
+        if (key.empty() || key.front() != c) {
+            return false;
+        }
+        key.remove_prefix(1);
+        raw.remove_prefix(raw_size);
+    }
+    return key.empty();
+}
+
+} // namespace
+
+void query_view::iterator::advance() {
+    is_end_ = true;
+    while (has_tail_) {
+        // split by '&'
+        const auto pair_split = detail::try_find_split_unlimited(tail_, "&");
+        const std::string_view pair_str = pair_split.head;
+        if (pair_split.tail.has_value()) {
+            tail_ = pair_split.tail.value();
+        } else {
+            has_tail_ = false;
+        }
+
+        if (pair_str.empty()) {
+            continue;
+        }
+
+        // split by '=' for key-value
+        const auto kv_split = detail::try_find_split_unlimited(pair_str, "=");
+        current_ = query_param_view{
+            .key = kv_split.head,
+            .value = kv_split.tail.value_or(pair_str.substr(pair_str.size())),
+        };
+        is_end_ = false;
+        return;
+    }
+}
+
+meta::maybe<std::string_view> query_view::find_raw(std::string_view key) const {
+    if (!index_.has_value() && ++lookup_count_ > index_threshold) {
+        build_index();
+    }
+    if (!index_.has_value()) {
+        return find_raw_scan(key);
+    }
+
+    const auto& index = index_.value();
+    const auto it = index.find(key);
+    if (it == index.end()) {
+        return meta::null;
+    }
+    return it.value();
+}
+
+meta::maybe<std::string_view> query_view::find(std::string_view key, std::span<char> buffer) const {
+    return find_raw(key).and_then([buffer](std::string_view raw_value) -> meta::maybe<std::string_view> {
+        if (!is_encoded(raw_value)) {
+            return raw_value;
+        }
+        if (raw_value.size() > buffer.size()) {
+            return meta::null;
+        }
+        const std::span<char> encoded = buffer.first(raw_value.size());
+        if (encoded.data() != raw_value.data()) { // `buffer` may be the raw value itself
+            std::ranges::copy(raw_value, encoded.begin());
+        }
+        return detail::percent_decode::query_in_place(encoded);
+    });
+}
+
+meta::maybe<std::string_view> query_view::find_raw_scan(std::string_view key) const {
+    for (const auto& [raw_key, raw_value] : *this) {
+        if (decoded_equals(raw_key, key)) {
+            return raw_value;
+        }
+    }
+    return meta::null;
+}
+
+void query_view::build_index() const {
+    auto& index = index_.emplace();
+    for (const auto& [raw_key, raw_value] : *this) {
+        auto maybe_key = detail::percent_decode::query(raw_key);
+        if (!maybe_key.has_value()) {
+            continue; // malformed keys can't match any lookup
+        }
+        // first occurrence wins, same as the linear scan
+        index.try_emplace(std::move(maybe_key).value(), raw_value);
+    }
+}
+
+} // namespace sl::http::v1
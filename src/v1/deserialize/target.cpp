@@ -3,9 +3,12 @@
 //
 
 #include "sl/http/v1/deserialize/target.hpp"
+#include "sl/http/v1/detail/chars.hpp"
 #include "sl/http/v1/detail/strings.hpp"
 
+#include <algorithm>
 #include <charconv>
+#include <cstring>
 
 namespace sl::http::v1 {
 
@@ -76,17 +79,102 @@ meta::maybe<origin_target_type> deserialize_origin_form(std::string_view target_
     return origin_target_type{
         .path = std::move(maybe_path).value(),
         .query = std::move(query),
+        .raw_path = raw_path.contains('%') ? std::string{ raw_path } : std::string{},
     };
 }
 
+meta::maybe<origin_target_view> deserialize_origin_form_in_place(std::span<char> target_buffer) {
+    const std::string_view target_str{ target_buffer.data(), target_buffer.size() };
+    // must start with '/'
+    if (!target_str.starts_with('/')) {
+        return meta::null;
+    }
+
+    // split at '?' for query, query stays encoded and is decoded lazily by query_view
+    auto split = try_find_split_unlimited(target_str, "?");
+    const std::string_view raw_query = split.tail.value_or(std::string_view{});
+
+    return percent_decode::str_in_place(target_buffer.subspan(0, split.head.size()))
+        .map([raw_query](std::string_view path) {
+            return origin_target_view{
+                .path = path,
+                .query = query_view{ raw_query },
+            };
+        });
+}
+
+namespace {
+
+meta::maybe<std::uint16_t> deserialize_port(std::string_view port_str) {
+    std::uint16_t port = 0;
+    const auto conv_result = std::from_chars(port_str.data(), port_str.data() + port_str.size(), port);
+    if (conv_result.ec != std::errc{} || conv_result.ptr != port_str.data() + port_str.size()) {
+        return meta::null;
+    }
+    return port;
+}
+
+bool is_ip_literal_char(char c) { return chars::hex_value(c) != chars::invalid_hex || c == ':' || c == '.'; }
+
+// authority = [ userinfo "@" ] host [ ":" port ]
+// fills userinfo, host and port of `target`, port falls back to the scheme default
+bool deserialize_authority(std::string_view authority, absolute_target_type& target) {
+    if (const auto at = authority.rfind('@'); at != std::string_view::npos) {
+        target.userinfo = authority.substr(0, at);
+        authority.remove_prefix(at + 1);
+    }
+
+    std::string_view host;
+    std::string_view port_part; // ":" port, or empty
+    if (authority.starts_with('[')) {
+        // IP-literal = "[" ( IPv6address / IPvFuture ) "]"
+        const auto close = authority.find(']');
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        host = authority.substr(1, close - 1);
+        port_part = authority.substr(close + 1);
+        if (host.empty() || !std::all_of(host.begin(), host.end(), is_ip_literal_char)) {
+            return false;
+        }
+    } else {
+        const auto colon = authority.find(':');
+        host = authority.substr(0, colon);
+        port_part = colon == std::string_view::npos ? std::string_view{} : authority.substr(colon);
+    }
+
+    if (host.empty()) {
+        return false; // http(s) URIs require a non-empty host
+    }
+    target.host = host;
+
+    // port may be empty: "http://example.com:/" is the same as without it
+    if (port_part.size() <= 1) {
+        target.port = default_port(target.scheme);
+        return port_part.empty() || port_part.front() == ':';
+    }
+    if (port_part.front() != ':') {
+        return false;
+    }
+    const auto maybe_port = deserialize_port(port_part.substr(1));
+    if (!maybe_port.has_value()) {
+        return false;
+    }
+    target.port = maybe_port.value();
+    return true;
+}
+
+} // namespace
+
 meta::maybe<absolute_target_type> deserialize_absolute_form(std::string_view target_str) {
+    absolute_target_type target{};
+
     // extract scheme
-    std::string scheme;
     if (target_str.starts_with("https://")) {
-        scheme = "https";
+        target.scheme = scheme_type::HTTPS;
         target_str.remove_prefix(8);
     } else if (target_str.starts_with("http://")) {
-        scheme = "http";
+        target.scheme = scheme_type::HTTP;
         target_str.remove_prefix(7);
     } else {
         return meta::null;
@@ -94,9 +182,7 @@ meta::maybe<absolute_target_type> deserialize_absolute_form(std::string_view tar
 
     // find authority/path boundary (first '/' after scheme)
     auto path_split = try_find_split_unlimited(target_str, "/");
-    std::string_view authority = path_split.head;
-
-    if (authority.empty()) {
+    if (!deserialize_authority(path_split.head, target)) {
         return meta::null;
     }
 
@@ -115,22 +201,20 @@ meta::maybe<absolute_target_type> deserialize_absolute_form(std::string_view tar
     if (!maybe_path.has_value()) {
         return meta::null;
     }
+    target.path = std::move(maybe_path).value();
+    if (raw_path.contains('%')) {
+        target.raw_path = std::move(raw_path);
+    }
 
-    query_params query;
     if (!raw_query.empty()) {
         auto maybe_query = deserialize_query_string(raw_query);
         if (!maybe_query.has_value()) {
             return meta::null;
         }
-        query = std::move(maybe_query).value();
+        target.query = std::move(maybe_query).value();
     }
 
-    return absolute_target_type{
-        .scheme = std::move(scheme),
-        .authority = std::string{ authority },
-        .path = std::move(maybe_path).value(),
-        .query = std::move(query),
-    };
+    return target;
 }
 
 meta::maybe<authority_target_type> deserialize_authority_form(std::string_view target_str) {
@@ -153,120 +237,121 @@ meta::maybe<authority_target_type> deserialize_authority_form(std::string_view t
         return meta::null;
     }
 
-    std::uint16_t port = 0;
-    auto conv_result = std::from_chars(port_str.data(), port_str.data() + port_str.size(), port);
-    if (conv_result.ec != std::errc{} || conv_result.ptr != port_str.data() + port_str.size()) {
-        return meta::null;
-    }
-
-    return authority_target_type{
-        .host = std::string{ host },
-        .port = port,
-    };
+    return deserialize_port(port_str).map([host](std::uint16_t port) {
+        return authority_target_type{
+            .host = std::string{ host },
+            .port = port,
+        };
+    });
 }
 
 meta::maybe<query_params> deserialize_query_string(std::string_view query_str) {
     query_params result;
 
-    while (!query_str.empty()) {
-        // split by '&'
-        auto pair_split = try_find_split_unlimited(query_str, "&");
-        std::string_view pair_str = pair_split.head;
-
-        if (!pair_str.empty()) {
-            // split by '=' for key-value
-            auto kv_split = try_find_split_unlimited(pair_str, "=");
-
-            auto maybe_key = percent_decode::query(kv_split.head);
-            if (!maybe_key.has_value()) {
-                return meta::null;
-            }
-
-            std::string value;
-            if (kv_split.tail.has_value()) {
-                auto maybe_value = percent_decode::query(kv_split.tail.value());
-                if (!maybe_value.has_value()) {
-                    return meta::null;
-                }
-                value = std::move(maybe_value).value();
-            }
-
-            result.emplace_back(std::move(maybe_key).value(), std::move(value));
+    for (const auto& [raw_key, raw_value] : query_view{ query_str }) {
+        auto maybe_key = percent_decode::query(raw_key);
+        if (!maybe_key.has_value()) {
+            return meta::null;
         }
 
-        if (!pair_split.tail.has_value()) {
-            break;
+        auto maybe_value = percent_decode::query(raw_value);
+        if (!maybe_value.has_value()) {
+            return meta::null;
         }
-        query_str = pair_split.tail.value();
+
+        result.emplace_back(std::move(maybe_key).value(), std::move(maybe_value).value());
     }
 
     return result;
 }
 
-meta::maybe<std::string> percent_decode::query(std::string_view encoded) {
-    std::string result;
-    result.reserve(encoded.size());
+namespace {
+
+// Copies clean runs in bulk and decodes escapes through a lookup table
+// `out` must have room for encoded.size() bytes, returns decoded size
+// `out` may alias `encoded`: writes never overtake reads since an escape shrinks 3 bytes into 1
+template <bool IsQuery>
+meta::maybe<std::size_t> percent_decode_into(std::string_view encoded, char* out) {
+    std::size_t written = 0;
+    const auto copy_clean = [&](std::size_t clean_size) {
+        if (clean_size != 0) {
+            std::memmove(out + written, encoded.data(), clean_size);
+            written += clean_size;
+            encoded.remove_prefix(clean_size);
+        }
+    };
 
-    for (std::size_t i = 0; i < encoded.size(); ++i) {
-        if (encoded[i] == '%') {
-            if (i + 2 >= encoded.size()) {
-                return meta::null;
-            }
-            auto maybe_char = byte(encoded[i + 1], encoded[i + 2]);
-            if (!maybe_char.has_value()) {
-                return meta::null;
+    while (true) {
+        const std::size_t clean_size = IsQuery ? find_first_of(encoded, '%', '+') : encoded.find('%');
+        if (clean_size == std::string_view::npos) {
+            copy_clean(encoded.size());
+            return written;
+        }
+        copy_clean(clean_size);
+
+        if constexpr (IsQuery) {
+            if (encoded.front() == '+') {
+                out[written++] = ' ';
+                encoded.remove_prefix(1);
+                continue;
             }
-            result += maybe_char.value();
-            i += 2;
-        } else if (encoded[i] == '+') {
-            result += ' ';
-        } else {
-            result += encoded[i];
         }
+
+        // "%" HEXDIG HEXDIG
+        if (encoded.size() < 3) {
+            return meta::null; // incomplete percent encoding
+        }
+        const auto maybe_char = percent_decode::byte(encoded[1], encoded[2]);
+        if (!maybe_char.has_value()) {
+            return meta::null;
+        }
+        out[written++] = maybe_char.value();
+        encoded.remove_prefix(3);
     }
+}
 
-    return result;
+template <bool IsQuery>
+meta::maybe<std::string> percent_decode_copy(std::string_view encoded) {
+    std::string result(encoded.size(), '\0');
+    return percent_decode_into<IsQuery>(encoded, result.data()).map([&result](std::size_t decoded_size) {
+        result.resize(decoded_size);
+        return std::move(result);
+    });
 }
 
-meta::maybe<std::string> percent_decode::str(std::string_view encoded) {
-    std::string result;
-    result.reserve(encoded.size());
+template <bool IsQuery>
+meta::maybe<std::string_view> percent_decode_in_place(std::span<char> encoded) {
+    const std::string_view encoded_str{ encoded.data(), encoded.size() };
+    return percent_decode_into<IsQuery>(encoded_str, encoded.data()).map([&encoded](std::size_t decoded_size) {
+        return std::string_view{ encoded.data(), decoded_size };
+    });
+}
 
-    for (std::size_t i = 0; i < encoded.size(); ++i) {
-        if (encoded[i] == '%') {
-            if (i + 2 >= encoded.size()) {
-                return meta::null; // incomplete percent encoding
-            }
-            auto maybe_char = byte(encoded[i + 1], encoded[i + 2]);
-            if (!maybe_char.has_value()) {
-                return meta::null;
-            }
-            result += maybe_char.value();
-            i += 2;
-        } else {
-            result += encoded[i];
-        }
-    }
+} // namespace
 
-    return result;
+meta::maybe<std::string> percent_decode::query(std::string_view encoded) {
+    return percent_decode_copy</*IsQuery=*/true>(encoded);
 }
 
-meta::maybe<char> percent_decode::byte(char high, char low) {
-    auto hex_to_val = [](char c) -> meta::maybe<int> {
-        if (c >= '0' && c <= '9') return c - '0';
-        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-        return meta::null;
-    };
+meta::maybe<std::string> percent_decode::str(std::string_view encoded) {
+    return percent_decode_copy</*IsQuery=*/false>(encoded);
+}
 
-    auto high_val = hex_to_val(high);
-    auto low_val = hex_to_val(low);
+meta::maybe<std::string_view> percent_decode::query_in_place(std::span<char> encoded) {
+    return percent_decode_in_place</*IsQuery=*/true>(encoded);
+}
+
+meta::maybe<std::string_view> percent_decode::str_in_place(std::span<char> encoded) {
+    return percent_decode_in_place</*IsQuery=*/false>(encoded);
+}
 
-    if (!high_val.has_value() || !low_val.has_value()) {
+meta::maybe<char> percent_decode::byte(char high, char low) {
+    const std::uint8_t high_val = chars::hex_value(high);
+    const std::uint8_t low_val = chars::hex_value(low);
+    if ((high_val | low_val) == chars::invalid_hex) {
         return meta::null;
     }
-
-    return static_cast<char>((high_val.value() << 4) | low_val.value());
+    return static_cast<char>((high_val << 4) | low_val);
 }
 
 } // namespace detail
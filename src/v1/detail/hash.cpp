@@ -0,0 +1,102 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/detail/hash.hpp"
+
+#include "sl/http/v1/detail/chars.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+
+namespace sl::http::v1::detail {
+namespace {
+
+using hash_seed_type = std::array<std::uint64_t, 2>;
+
+const hash_seed_type& hash_seed() {
+    static const hash_seed_type seed = [] {
+        std::random_device device;
+        const auto next = [&device] { return (std::uint64_t{ device() } << 32) | device(); };
+        return hash_seed_type{ next(), next() };
+    }();
+    return seed;
+}
+
+constexpr char identity(char c) { return c; }
+
+struct sip_state {
+    std::uint64_t v0;
+    std::uint64_t v1;
+    std::uint64_t v2;
+    std::uint64_t v3;
+
+    void round() {
+        v0 += v1;
+        v1 = std::rotl(v1, 13);
+        v1 ^= v0;
+        v0 = std::rotl(v0, 32);
+        v2 += v3;
+        v3 = std::rotl(v3, 16);
+        v3 ^= v2;
+        v0 += v3;
+        v3 = std::rotl(v3, 21);
+        v3 ^= v0;
+        v2 += v1;
+        v1 = std::rotl(v1, 17);
+        v1 ^= v2;
+        v2 = std::rotl(v2, 32);
+    }
+
+    void compress(std::uint64_t m) {
+        v3 ^= m;
+        round();
+        v0 ^= m;
+    }
+};
+
+// little-endian word out of up to 8 bytes, each mapped by F
+template <char (*F)(char)>
+std::uint64_t load_word(const char* data, std::size_t size) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        word |= std::uint64_t{ static_cast<std::uint8_t>(F(data[i])) } << (8 * i);
+    }
+    return word;
+}
+
+template <char (*F)(char)>
+std::uint64_t siphash13(std::string_view str) {
+    const auto& [k0, k1] = hash_seed();
+    sip_state state{
+        .v0 = k0 ^ 0x736f6d6570736575ULL,
+        .v1 = k1 ^ 0x646f72616e646f6dULL,
+        .v2 = k0 ^ 0x6c7967656e657261ULL,
+        .v3 = k1 ^ 0x7465646279746573ULL,
+    };
+
+    const std::size_t tail_size = str.size() % 8;
+    const std::size_t body_size = str.size() - tail_size;
+    for (std::size_t i = 0; i < body_size; i += 8) {
+        state.compress(load_word<F>(str.data() + i, 8));
+    }
+    state.compress(load_word<F>(str.data() + body_size, tail_size) | (std::uint64_t{ str.size() & 0xFF } << 56));
+
+    state.v2 ^= 0xFF;
+    state.round();
+    state.round();
+    state.round();
+    return state.v0 ^ state.v1 ^ state.v2 ^ state.v3;
+}
+
+} // namespace
+
+std::size_t seeded_hash(std::string_view str) noexcept { return static_cast<std::size_t>(siphash13<identity>(str)); }
+
+std::size_t seeded_hash_lowercase(std::string_view str) noexcept {
+    return static_cast<std::size_t>(siphash13<chars::to_lower>(str));
+}
+
+} // namespace sl::http::v1::detail
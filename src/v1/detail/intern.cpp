@@ -0,0 +1,148 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/detail/intern.hpp"
+
+#include "sl/http/v1/detail/hash.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <tuple>
+
+namespace sl::http::v1::detail {
+namespace {
+
+// open addressing with linear probing, at most half full so probes stay short
+constexpr std::size_t slot_count = max_interned_field_name_count * 2;
+static_assert((slot_count & (slot_count - 1)) == 0);
+
+constexpr std::string_view common_field_names[]{
+    "accept",
+    "accept-charset",
+    "accept-encoding",
+    "accept-language",
+    "accept-ranges",
+    "access-control-allow-origin",
+    "age",
+    "allow",
+    "authorization",
+    "cache-control",
+    "connection",
+    "content-disposition",
+    "content-encoding",
+    "content-language",
+    "content-length",
+    "content-location",
+    "content-range",
+    "content-security-policy",
+    "content-type",
+    "cookie",
+    "date",
+    "etag",
+    "expect",
+    "expires",
+    "forwarded",
+    "host",
+    "if-match",
+    "if-modified-since",
+    "if-none-match",
+    "if-range",
+    "if-unmodified-since",
+    "keep-alive",
+    "last-modified",
+    "link",
+    "location",
+    "origin",
+    "pragma",
+    "proxy-authenticate",
+    "proxy-authorization",
+    "range",
+    "referer",
+    "retry-after",
+    "server",
+    "set-cookie",
+    "strict-transport-security",
+    "te",
+    "trailer",
+    "transfer-encoding",
+    "upgrade",
+    "user-agent",
+    "vary",
+    "via",
+    "www-authenticate",
+    "x-forwarded-for",
+    "x-forwarded-host",
+    "x-forwarded-proto",
+    "x-real-ip",
+    "x-request-id",
+};
+
+class intern_table {
+public:
+    intern_table() {
+        std::ignore = intern(""); // moved-from field_name
+        for (const std::string_view name : common_field_names) {
+            std::ignore = intern(name);
+        }
+    }
+
+    const interned_field_name* intern(std::string_view name) {
+        const std::size_t hash = seeded_hash(name);
+        std::unique_ptr<interned_field_name> candidate;
+        for (std::size_t i = hash & (slot_count - 1);; i = (i + 1) & (slot_count - 1)) {
+            const interned_field_name* entry = slots_[i].load(std::memory_order_acquire);
+            while (entry == nullptr) {
+                if (count_.load(std::memory_order_relaxed) >= max_interned_field_name_count) {
+                    return nullptr;
+                }
+                if (candidate == nullptr) {
+                    candidate = std::make_unique<interned_field_name>(std::string{ name }, hash);
+                }
+                if (slots_[i].compare_exchange_strong(entry, candidate.get(), std::memory_order_acq_rel)) {
+                    count_.fetch_add(1, std::memory_order_relaxed);
+                    return candidate.release();
+                }
+                // lost the slot, entry now holds the winner
+            }
+            if (entry->hash == hash && entry->name == name) {
+                return entry;
+            }
+        }
+    }
+
+    const interned_field_name* find(std::string_view name) const {
+        const std::size_t hash = seeded_hash(name);
+        for (std::size_t i = hash & (slot_count - 1);; i = (i + 1) & (slot_count - 1)) {
+            const interned_field_name* entry = slots_[i].load(std::memory_order_acquire);
+            if (entry == nullptr) {
+                return nullptr;
+            }
+            if (entry->hash == hash && entry->name == name) {
+                return entry;
+            }
+        }
+    }
+
+    std::size_t count() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<const interned_field_name*>, slot_count> slots_{};
+    std::atomic<std::size_t> count_ = 0;
+};
+
+intern_table& get_intern_table() {
+    static intern_table table;
+    return table;
+}
+
+} // namespace
+
+const interned_field_name* intern_field_name(std::string_view name) { return get_intern_table().intern(name); }
+
+const interned_field_name* find_interned_field_name(std::string_view name) { return get_intern_table().find(name); }
+
+std::size_t interned_field_name_count() { return get_intern_table().count(); }
+
+} // namespace sl::http::v1::detail
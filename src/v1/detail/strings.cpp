@@ -4,11 +4,14 @@
 
 #include "sl/http/v1/detail/strings.hpp"
 
+#include "sl/http/v1/detail/chars.hpp"
+
 #include <sl/meta/assert.hpp>
 
 #include <algorithm>
 #include <bit>
-#include <cctype>
+#include <cstdint>
+#include <cstring>
 
 namespace sl::http::v1::detail {
 
@@ -25,19 +28,20 @@ std::span<const std::byte> buffer_str_to_byte(std::string_view str_buffer) {
 std::string to_lowercase(std::string_view str) {
     std::string result;
     result.reserve(str.size());
-    std::transform(str.begin(), str.end(), std::back_inserter(result), [](unsigned char c) {
-        return static_cast<char>(std::tolower(c));
-    });
+    std::transform(str.begin(), str.end(), std::back_inserter(result), chars::to_lower);
     return result;
 }
 
 bool is_lowercase(std::string_view str) {
-    for (unsigned char c : str) {
-        if (std::isalpha(c) && !std::islower(c)) {
-            return false;
-        }
-    }
-    return true;
+    return std::ranges::all_of(str, [](char c) { return chars::to_lower(c) == c; });
+}
+
+bool equals_lowercase(std::string_view str, std::string_view lowercase) {
+    DEBUG_ASSERT(is_lowercase(lowercase));
+    return str.size() == lowercase.size()
+           && std::equal(str.begin(), str.end(), lowercase.begin(), [](char c, char lower) {
+                  return chars::to_lower(c) == lower;
+              });
 }
 
 std::string_view strip_prefix(std::string_view str, std::string_view prefix) {
@@ -64,6 +68,30 @@ std::string_view strip_suffix(std::string_view str, char suffix) {
     return str;
 }
 
+std::size_t find_first_of(std::string_view str, char a, char b) {
+    constexpr std::uint64_t ones = 0x0101010101010101;
+    constexpr std::uint64_t highs = 0x8080808080808080;
+    constexpr auto has_zero_byte = [](std::uint64_t x) { return (x - ones) & ~x & highs; };
+
+    const std::uint64_t a_pattern = ones * static_cast<std::uint8_t>(a);
+    const std::uint64_t b_pattern = ones * static_cast<std::uint8_t>(b);
+
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= str.size(); i += sizeof(std::uint64_t)) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, str.data() + i, sizeof(word));
+        if (has_zero_byte(word ^ a_pattern) | has_zero_byte(word ^ b_pattern)) {
+            break; // exact position is resolved below
+        }
+    }
+    for (; i < str.size(); ++i) {
+        if (str[i] == a || str[i] == b) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
 meta::result<find_ok, find_err> try_find_unlimited(std::string_view str_buffer, std::string_view delim) {
     const std::size_t it = str_buffer.find(delim);
 
@@ -115,4 +143,74 @@ find_split_result try_find_split(std::string_view str_buffer, std::string_view d
     return find_split_result{ .head = result->value, .tail = str_buffer.substr(result->offset) };
 }
 
+meta::result<field_line_ok, field_line_err>
+    scan_field_line(std::string_view str_buffer, std::size_t max_size, std::span<char> lowercase_buffer) {
+    // avoiding integer overflows
+    if (!DEBUG_ASSERT_VAL(max_size <= str_buffer.max_size() - tokens::CRLF.size())) {
+        return meta::err(field_line_err::MAX_SIZE_EXCEEDED);
+    }
+    const std::size_t max_size_w_crlf = max_size + tokens::CRLF.size();
+    const std::size_t limit = std::min(max_size_w_crlf, str_buffer.size());
+    const auto not_found = [&] {
+        return meta::err(
+            max_size_w_crlf <= str_buffer.size() ? field_line_err::MAX_SIZE_EXCEEDED : field_line_err::NOT_FOUND
+        );
+    };
+
+    std::size_t i = 0;
+    for (; i < limit && chars::is(str_buffer[i], chars::tchar); ++i) {
+        if (i < lowercase_buffer.size()) {
+            lowercase_buffer[i] = chars::to_lower(str_buffer[i]);
+        }
+    }
+    if (i == limit) {
+        return not_found();
+    }
+
+    if (i == 0) { // CRLF ending the field section
+        if (str_buffer[0] != '\r') {
+            return meta::err(field_line_err::MALFORMED);
+        }
+        if (limit < tokens::CRLF.size()) {
+            return not_found();
+        }
+        if (str_buffer[1] != '\n') {
+            return meta::err(field_line_err::MALFORMED);
+        }
+        return field_line_ok{ .name = {}, .lowercase_name = {}, .value = {}, .offset = tokens::CRLF.size() };
+    }
+    // no whitespace between field-name and ":", RFC 9112 5.1
+    if (str_buffer[i] != ':') {
+        return meta::err(field_line_err::MALFORMED);
+    }
+    const auto name = str_buffer.substr(0, i);
+    const auto lowercase_name = name.size() <= lowercase_buffer.size()
+                                    ? std::string_view{ lowercase_buffer.data(), name.size() }
+                                    : std::string_view{};
+
+    for (++i; i < limit && tokens::is_ws(str_buffer[i]); ++i) {}
+    const std::size_t value_begin = i;
+    while (true) {
+        const void* cr = std::memchr(str_buffer.data() + i, '\r', limit - i);
+        if (cr == nullptr) {
+            return not_found();
+        }
+        i = static_cast<std::size_t>(static_cast<const char*>(cr) - str_buffer.data());
+        if (i + 1 == limit) {
+            return not_found();
+        }
+        if (str_buffer[i + 1] == '\n') {
+            break;
+        }
+        ++i; // a bare CR belongs to the value
+    }
+
+    return field_line_ok{
+        .name = name,
+        .lowercase_name = lowercase_name,
+        .value = strip_suffix_while(str_buffer.substr(value_begin, i - value_begin), tokens::is_ws),
+        .offset = i + tokens::CRLF.size(),
+    };
+}
+
 } // namespace sl::http::v1::detail
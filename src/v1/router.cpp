@@ -0,0 +1,260 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/router.hpp"
+#include "sl/http/v1/deserialize/target.hpp"
+
+namespace sl::http::v1::detail {
+namespace {
+
+bool is_capture_segment(std::string_view segment) { return segment.starts_with(':') || segment.starts_with('*'); }
+
+std::string_view first_segment(std::string_view str) { return str.substr(0, str.find('/')); }
+
+// size of the prefix of path that decodes to label, npos if there is none
+// a '/' of label only matches a '/' of path, never an escaped one, so segments are split before decoding
+std::size_t decoded_prefix_size(std::string_view path, std::string_view label, bool is_encoded) {
+    if (!is_encoded) {
+        return path.starts_with(label) ? label.size() : std::string_view::npos;
+    }
+    std::size_t i = 0;
+    for (const char c : label) {
+        if (i == path.size()) {
+            return std::string_view::npos;
+        }
+        if (path[i] != '%') {
+            if (path[i] != c) {
+                return std::string_view::npos;
+            }
+            ++i;
+            continue;
+        }
+        if (c == '/' || i + 2 >= path.size()) {
+            return std::string_view::npos;
+        }
+        const auto maybe_byte = percent_decode::byte(path[i + 1], path[i + 2]);
+        if (!maybe_byte.has_value() || maybe_byte.value() != c) {
+            return std::string_view::npos;
+        }
+        i += 3;
+    }
+    return i;
+}
+
+// longest common prefix of a and b that ends on a segment boundary in both
+std::size_t common_segments_size(std::string_view a, std::string_view b) {
+    std::size_t mismatch = 0;
+    while (mismatch < a.size() && mismatch < b.size() && a[mismatch] == b[mismatch]) {
+        ++mismatch;
+    }
+    for (std::size_t size = mismatch;; --size) {
+        const bool is_a_boundary = size == a.size() || a[size] == '/';
+        const bool is_b_boundary = size == b.size() || b[size] == '/';
+        if ((is_a_boundary && is_b_boundary) || size == 0) {
+            return size;
+        }
+    }
+}
+
+} // namespace
+
+route_tree::route_tree() { make_node({}); }
+
+std::error_code route_tree::insert(method_type method, std::string_view pattern, value_index index) {
+    if (method >= method_type::ENUM_END || !pattern.starts_with('/')) {
+        return std::make_error_code(std::errc::invalid_argument);
+    }
+
+    std::vector<std::string_view> segments;
+    for (std::string_view rest = pattern.substr(1);;) {
+        const std::size_t slash = rest.find('/');
+        segments.push_back(rest.substr(0, slash));
+        if (slash == std::string_view::npos) {
+            break;
+        }
+        rest = rest.substr(slash + 1);
+    }
+
+    node_index current = 0;
+    std::size_t capture_count = 0;
+    for (std::size_t i = 0; i < segments.size();) {
+        const std::string_view segment = segments[i];
+        if (!is_capture_segment(segment)) {
+            std::size_t run_end = i + 1;
+            while (run_end < segments.size() && !is_capture_segment(segments[run_end])) {
+                ++run_end;
+            }
+            const std::string_view last = segments[run_end - 1];
+            insert_static(current, std::string_view{ segment.data(), last.data() + last.size() });
+            i = run_end;
+            continue;
+        }
+
+        const bool is_wildcard = segment.starts_with('*');
+        const std::string_view name = segment.substr(1);
+        if (name.empty() || (is_wildcard && i + 1 != segments.size())
+            || ++capture_count > route_captures::max_size) {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        auto maybe_child = is_wildcard ? nodes_[current].wildcard : nodes_[current].param;
+        if (!maybe_child.has_value()) {
+            const node_index child = make_node({});
+            nodes_[child].capture_name = name;
+            (is_wildcard ? nodes_[current].wildcard : nodes_[current].param) = child;
+            maybe_child = child;
+        } else if (nodes_[maybe_child.value()].capture_name != name) {
+            // same position has to be captured under the same name by every route
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+        current = maybe_child.value();
+        ++i;
+    }
+
+    auto& endpoint = nodes_[current].endpoint;
+    const method_mask bit = method_bit(method);
+    if ((endpoint.methods & bit) != 0) {
+        return std::make_error_code(std::errc::file_exists);
+    }
+    endpoint.methods |= bit;
+    endpoint.values[static_cast<std::size_t>(method)] = index;
+    return {};
+}
+
+meta::result<route_tree::match_type, status_type>
+    route_tree::match(method_type method, std::string_view path, bool is_encoded) const {
+    if (method >= method_type::ENUM_END || !path.starts_with('/')) {
+        return meta::err(status_type::NOT_FOUND);
+    }
+
+    match_state state{ .method_bit = method_bit(method), .is_encoded = is_encoded && path.contains('%') };
+    if (!match_children(0, path.substr(1), state)) {
+        return meta::err(state.is_path_matched ? status_type::METHOD_NOT_ALLOWED : status_type::NOT_FOUND);
+    }
+    return match_type{
+        .index = state.endpoint->values[static_cast<std::size_t>(method)],
+        .captures = state.captures,
+    };
+}
+
+route_tree::node_index route_tree::make_node(std::string label) {
+    const auto index = static_cast<node_index>(nodes_.size());
+    auto& node = nodes_.emplace_back();
+    node.label = std::move(label);
+    node.endpoint.values.fill(no_index);
+    return index;
+}
+
+// run: one or more static segments joined by '/'
+void route_tree::insert_static(node_index& current, std::string_view run) {
+    while (true) {
+        const std::string_view first = first_segment(run);
+        const auto it = nodes_[current].children.find(first);
+        if (it == nodes_[current].children.end()) {
+            const node_index child = make_node(std::string{ run });
+            nodes_[current].children.emplace(std::string{ first }, child);
+            current = child;
+            return;
+        }
+
+        const node_index child = it->second;
+        const std::string label = nodes_[child].label;
+        const std::size_t common_size = common_segments_size(label, run);
+
+        if (common_size < label.size()) {
+            // split child at the segment boundary, the common part becomes a new parent
+            const node_index parent = make_node(label.substr(0, common_size));
+            std::string child_label = label.substr(common_size + 1);
+            const std::string child_first{ first_segment(child_label) };
+            nodes_[child].label = std::move(child_label);
+            nodes_[parent].children.emplace(child_first, child);
+            nodes_[current].children.insert_or_assign(std::string{ first }, parent);
+            current = parent;
+        } else {
+            current = child;
+        }
+
+        if (common_size == run.size()) {
+            return;
+        }
+        run = run.substr(common_size + 1);
+    }
+}
+
+// rest: starts at a segment
+bool route_tree::match_children(node_index node, std::string_view rest, match_state& state) const {
+    const node_type& current = nodes_[node];
+    const std::string_view segment = first_segment(rest);
+
+    if (!state.is_encoded || !segment.contains('%')) {
+        if (const auto it = current.children.find(segment);
+            it != current.children.end() && match_node(it->second, rest, state)) {
+            return true;
+        }
+    } else {
+        // children are keyed by decoded segments, at most one of them decodes from this one
+        for (const auto& [first, child] : current.children) {
+            if (decoded_prefix_size(segment, first, /*is_encoded=*/true) == segment.size()) {
+                if (match_node(child, rest, state)) {
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+
+    if (current.param.has_value() && !segment.empty()) {
+        const node_index param = current.param.value();
+        state.captures.push({ .name = nodes_[param].capture_name, .value = segment });
+        if (match_after(param, rest.substr(segment.size()), state)) {
+            return true;
+        }
+        state.captures.pop();
+    }
+
+    if (current.wildcard.has_value()) {
+        const node_index wildcard = current.wildcard.value();
+        state.captures.push({ .name = nodes_[wildcard].capture_name, .value = rest });
+        if (match_endpoint(nodes_[wildcard].endpoint, state)) {
+            return true;
+        }
+        state.captures.pop();
+    }
+
+    return false;
+}
+
+bool route_tree::match_node(node_index node, std::string_view rest, match_state& state) const {
+    const std::size_t label_size = decoded_prefix_size(rest, nodes_[node].label, state.is_encoded);
+    if (label_size == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view tail = rest.substr(label_size);
+    if (!tail.empty() && tail.front() != '/') {
+        return false;
+    }
+    return match_after(node, tail, state);
+}
+
+// tail: either empty or starts with '/'
+bool route_tree::match_after(node_index node, std::string_view tail, match_state& state) const {
+    if (tail.empty()) {
+        return match_endpoint(nodes_[node].endpoint, state);
+    }
+    return match_children(node, tail.substr(1), state);
+}
+
+bool route_tree::match_endpoint(const endpoint_type& endpoint, match_state& state) {
+    if (endpoint.methods == 0) {
+        return false;
+    }
+    if ((endpoint.methods & state.method_bit) == 0) {
+        state.is_path_matched = true;
+        return false;
+    }
+    state.endpoint = &endpoint;
+    return true;
+}
+
+} // namespace sl::http::v1::detail
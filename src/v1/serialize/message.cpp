@@ -7,27 +7,81 @@
 #include "sl/http/v1/serialize/target.hpp"
 
 #include <sl/meta/match/overloaded.hpp>
+
+#include <algorithm>
 #include <variant>
 
 namespace sl::http::v1 {
 
-meta::unique_function<std::span<const std::byte>(std::size_t written)>
+meta::unique_function<meta::result<std::span<const std::byte>, std::error_code>(std::size_t written)>
     make_serialize(const message_type& message, serialize_config config) {
     return [machine = detail::serialize_machine{ message, config }](std::size_t written) mutable {
         return machine.resume(written);
     };
 }
 
+std::span<const std::byte> serialize_continue() {
+    static constexpr std::string_view continue_response = "HTTP/1.1 100 Continue\r\n\r\n";
+    return detail::buffer_str_to_byte(continue_response);
+}
+
 namespace detail {
+namespace {
+
+// field names are case-insensitive, a name the application spelled e.g. "Connection" is not interned
+bool has_connection_field(const fields_type& fields) {
+    return contains_field(fields, field_key_v<"connection">) || std::ranges::any_of(fields, [](const auto& field) {
+               return equals_lowercase(field.first.view(), "connection");
+           });
+}
+
+// Writes the Connection field matching framing.connection, unless the fields already have one
+// or the verdict is the default for both ends anyway, e.g. an HTTP/1.0 peer needs keep-alive spelled out
+void write_connection_field(const message_type& message, const serialize_config& config, const auto& write) {
+    const auto connection = message.framing.connection;
+    if (connection == connection_type::UNSPECIFIED) {
+        return;
+    }
+    const auto version = std::visit([](const auto& start_line) { return start_line.version; }, message.start_line);
+    if (connection == default_connection(version) && config.peer_version.has_value()
+        && connection == default_connection(config.peer_version.value())) {
+        return;
+    }
+    if (has_connection_field(message.fields)) {
+        return;
+    }
+
+    const std::string_view option = [connection] {
+        switch (connection) {
+        case connection_type::KEEP_ALIVE:
+            return "keep-alive";
+        case connection_type::CLOSE:
+            return "close";
+        case connection_type::UPGRADE:
+            return "upgrade";
+        default:
+            return "";
+        }
+    }();
+    write("connection");
+    write(tokens::COLON);
+    write(option);
+    write(tokens::CRLF);
+}
 
-std::span<const std::byte> serialize_machine::resume(std::size_t written) & {
+} // namespace
+
+meta::result<std::span<const std::byte>, std::error_code> serialize_machine::resume(std::size_t written) & {
     if (!remainder_.view().empty()) {
         remainder_.add_offset(written);
-        return remainder_.view();
+        if (!remainder_.view().empty()) {
+            return remainder_.view();
+        }
+        written = 0; // drained, carry on with the message
     }
 
     if (std::holds_alternative<serialize_state_complete>(state_)) {
-        return {};
+        return std::span<const std::byte>{};
     }
 
     if (auto* state = std::get_if<serialize_state_body>(&state_)) {
@@ -36,16 +90,21 @@ std::span<const std::byte> serialize_machine::resume(std::size_t written) & {
     }
 
     while (remainder_.view().size_bytes() < config_.buffer_size //
-           && !std::holds_alternative<serialize_state_complete>(state_)) {
+           && !std::holds_alternative<serialize_state_complete>(state_)
+           && !std::holds_alternative<serialize_state_error>(state_)) {
         state_ = std::visit(
             meta::overloaded{
                 [](const serialize_state_complete& state) { return serialize_state{ state }; },
+                [](const serialize_state_error& state) { return serialize_state{ state }; },
                 [this](const auto& state) { return resume_impl(message_, remainder_, config_, state); },
             },
             state_
         );
     }
 
+    if (const auto* error_state = std::get_if<serialize_state_error>(&state_)) {
+        return meta::err(error_state->error);
+    }
     return remainder_.view();
 }
 
@@ -93,7 +152,11 @@ serialize_state serialize_machine::resume_impl(
     const auto write = [&remainder](std::string_view str) { std::ignore = remainder.merge(buffer_str_to_byte(str)); };
 
     if (state.it == message.fields.end()) {
+        write_connection_field(message, config, write);
         write(tokens::CRLF);
+        if (message.body_file.has_value()) {
+            return serialize_state_body_file{ .offset = 0 };
+        }
         return serialize_state_body{ .offset = 0 };
     }
 
@@ -121,6 +184,35 @@ serialize_state serialize_machine::resume_impl(
     return serialize_state_body{ .offset = offset };
 }
 
+serialize_state serialize_machine::resume_impl(
+    const message_type& message,
+    remainder_buffer<>& remainder,
+    const serialize_config& config,
+    const serialize_state_body_file& state
+) {
+    const body_file_type& body_file = message.body_file.value();
+    if (state.offset == body_file.size()) {
+        return serialize_state_complete{};
+    }
+
+    DEBUG_ASSERT(remainder.view().size_bytes() < config.buffer_size);
+    const std::size_t size =
+        std::min(config.buffer_size - remainder.view().size_bytes(), body_file.size() - state.offset);
+    std::error_code read_error;
+    const std::size_t read_size = remainder.fill(size, [&](std::span<std::byte> buffer) -> std::size_t {
+        const auto read_result = body_file.read(state.offset, buffer);
+        if (!read_result.has_value()) {
+            read_error = read_result.error();
+            return 0;
+        }
+        return read_result.value();
+    });
+    if (read_size != size) { // the file failed to read or was truncated underneath
+        return serialize_state_error{ .error = read_error ? read_error : std::make_error_code(std::errc::io_error) };
+    }
+    return serialize_state_body_file{ .offset = state.offset + read_size };
+}
+
 std::error_code verify(const message_type& message) {
     if (const auto* response_line = std::get_if<response_line_type>(&message.start_line)) {
         const auto& reason = response_line->reason;
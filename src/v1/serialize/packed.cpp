@@ -0,0 +1,90 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/serialize/packed.hpp"
+
+#include "sl/http/v1/detail/strings.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+
+namespace sl::http::v1 {
+namespace {
+
+constexpr std::string_view field_separator = ": ";
+
+} // namespace
+
+void serialize_head(
+    const packed_message& message,
+    const head_edits& edits,
+    std::vector<std::span<const std::byte>>& output
+) {
+    output.clear();
+    const std::string_view head = message.raw_head();
+    const auto emit = [&output](std::string_view x) {
+        if (!x.empty()) {
+            output.push_back(detail::buffer_str_to_byte(x));
+        }
+    };
+    const auto emit_field = [&emit](std::string_view name, std::string_view value) {
+        emit(name);
+        emit(field_separator);
+        emit(value);
+        emit(detail::tokens::CRLF);
+    };
+
+    if (edits.empty()) {
+        emit(head);
+        return;
+    }
+
+    constexpr detail::case_insensitive_equal equal_names{};
+    std::vector<bool> is_replaced(edits.replaced.size(), false);
+    std::size_t copied = 0; // head before it is either emitted or dropped
+    for (const packed_field& field : message.fields()) {
+        if (field.name.offset >= head.size()) {
+            break; // trailers
+        }
+        const std::string_view name = message.view(field.name);
+        const auto replaced_it = std::ranges::find_if(edits.replaced, [&](const auto& kv) {
+            return equal_names(kv.first, name);
+        });
+        const bool is_removed = edits.removed.contains(name);
+        if (!is_removed && replaced_it == edits.replaced.end()) {
+            continue; // stays in the current run
+        }
+
+        // only OWS is between the value and CRLF
+        const std::size_t line_end = head.find(detail::tokens::CRLF, field.value.offset + field.value.size);
+        DEBUG_ASSERT(line_end != std::string_view::npos);
+        emit(head.substr(copied, field.name.offset - copied));
+        copied = line_end + detail::tokens::CRLF.size();
+
+        if (is_removed || replaced_it == edits.replaced.end()) {
+            continue;
+        }
+        const auto replaced_index = static_cast<std::size_t>(std::distance(edits.replaced.begin(), replaced_it));
+        if (!is_replaced[replaced_index]) {
+            is_replaced[replaced_index] = true;
+            emit_field(name, replaced_it->second);
+        }
+    }
+
+    // everything up to the empty line
+    DEBUG_ASSERT(head.ends_with(detail::tokens::CRLF));
+    emit(head.substr(copied, head.size() - detail::tokens::CRLF.size() - copied));
+    for (std::size_t i = 0; i < edits.replaced.size(); ++i) {
+        if (!is_replaced[i]) {
+            emit_field(edits.replaced[i].first, edits.replaced[i].second);
+        }
+    }
+    for (const auto& [name, value] : edits.added) {
+        emit_field(name, value);
+    }
+    emit(detail::tokens::CRLF);
+}
+
+} // namespace sl::http::v1
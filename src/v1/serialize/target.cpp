@@ -3,9 +3,9 @@
 //
 
 #include "sl/http/v1/serialize/target.hpp"
+#include "sl/http/v1/detail/chars.hpp"
 
 #include <algorithm>
-#include <array>
 #include <variant>
 
 namespace sl::http::v1 {
@@ -18,25 +18,41 @@ namespace detail {
 
 std::string serialize_impl(const origin_target_type& target) {
     std::string result;
-    const std::size_t result_size = percent_encode::path_size(target.path) //
-                                    + percent_encode::query_size(target.query);
-    result.reserve(result_size);
+    result.reserve(target.path.size() + percent_encode::unescaped_query_size(target.query));
     percent_encode::serialize_path(result, target.path);
     percent_encode::serialize_query(result, target.query);
     return result;
 }
+// userinfo is never written, see RFC 9110 4.2.4
+// port is omitted when it's unset or the scheme default
 std::string serialize_impl(const absolute_target_type& target) {
-    std::string result;
+    const std::string_view scheme = enum_to_str(target.scheme);
     constexpr std::string_view separator = "://";
-    const std::size_t result_size = target.scheme.size() //
-                                    + separator.size() //
-                                    + target.authority.size() //
-                                    + percent_encode::path_size(target.path) //
-                                    + percent_encode::query_size(target.query);
-    result.reserve(result_size);
-    result += target.scheme;
+    const bool is_ip_literal = target.host.find(':') != std::string::npos;
+    const bool has_port = target.port != 0 && target.port != default_port(target.scheme);
+
+    std::string result;
+    result.reserve(
+        scheme.size() //
+        + separator.size() //
+        + target.host.size() + 2 // '[' and ']'
+        + 6 // ':' and port max 65535
+        + target.path.size() //
+        + percent_encode::unescaped_query_size(target.query)
+    );
+    result += scheme;
     result += separator;
-    result += target.authority;
+    if (is_ip_literal) {
+        result += '[';
+        result += target.host;
+        result += ']';
+    } else {
+        result += target.host;
+    }
+    if (has_port) {
+        result += ':';
+        result += std::to_string(target.port);
+    }
     percent_encode::serialize_path(result, target.path);
     percent_encode::serialize_query(result, target.query);
     return result;
@@ -54,37 +70,16 @@ std::string serialize_impl(const authority_target_type& target) {
 }
 std::string serialize_impl(const asterisk_target_type&) { return "*"; }
 
-bool percent_encode::is_unreserved(char c) {
-    constexpr std::array allowed{ '-', '.', '_', '~' };
-    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
-           || std::find(allowed.begin(), allowed.end(), c) != allowed.end();
-}
-bool percent_encode::is_path_safe(char c) {
-    constexpr std::array allowed{ '/', ':', '@', '!', '$', '&', '\'', '(', ')', '*', '+', ',', ';', '=' };
-    return is_unreserved(c) || std::find(allowed.begin(), allowed.end(), c) != allowed.end();
-}
+bool percent_encode::is_unreserved(char c) { return chars::is(c, chars::unreserved); }
+bool percent_encode::is_path_safe(char c) { return chars::is(c, chars::path_safe); }
 
-std::size_t percent_encode::path_size(std::string_view path) {
-    std::size_t result = path.size();
-    for (char c : path) {
-        result += is_path_safe(c) ? 0 : 2; // should compile to branchless
-    }
-    return result;
-}
-std::size_t percent_encode::query_size(const query_params& query) {
-    std::size_t size = query.size() * 2; // ('&' or '?') + '='
+std::size_t percent_encode::unescaped_query_size(const query_params& query) {
+    std::size_t size = 0;
     for (const auto& [key, value] : query) {
-        size += query_size(key) + query_size(value);
+        size += 1 + key.size() + 1 + value.size(); // ('?' or '&') key '=' value
     }
     return size;
 }
-std::size_t percent_encode::query_size(std::string_view query_str) {
-    std::size_t result = query_str.size();
-    for (char c : query_str) {
-        result += (is_unreserved(c) || c == ' ') ? 0 : 2; // should compile to branchless
-    }
-    return result;
-}
 
 void percent_encode::append(std::string& result, char c) {
     constexpr char hex_chars[] = "0123456789ABCDEF";
@@ -93,16 +88,28 @@ void percent_encode::append(std::string& result, char c) {
     result += hex_chars[static_cast<std::uint8_t>(c) & 0x0F];
 }
 
-void percent_encode::serialize_path(std::string& result, std::string_view path) {
-    for (char c : path) {
-        if (is_path_safe(c)) {
-            result += c;
-        } else {
-            append(result, c);
+namespace {
+
+// Appends runs of `cls` chars in bulk, everything else goes through `encode`
+void serialize_runs(std::string& result, std::string_view str, std::uint8_t cls, auto encode) {
+    while (!str.empty()) {
+        const auto run_end = std::find_if_not(str.begin(), str.end(), [cls](char c) { return chars::is(c, cls); });
+        const auto run_size = static_cast<std::size_t>(std::distance(str.begin(), run_end));
+        result.append(str.substr(0, run_size));
+        if (run_size == str.size()) {
+            break;
         }
+        encode(result, str[run_size]);
+        str.remove_prefix(run_size + 1);
     }
 }
 
+} // namespace
+
+void percent_encode::serialize_path(std::string& result, std::string_view path) {
+    serialize_runs(result, path, chars::path_safe, &percent_encode::append);
+}
+
 void percent_encode::serialize_query(std::string& result, const query_params& query) {
     bool first = true;
     for (const auto& [key, value] : query) {
@@ -115,15 +122,13 @@ void percent_encode::serialize_query(std::string& result, const query_params& qu
 }
 
 void percent_encode::serialize_query(std::string& result, std::string_view query_str) {
-    for (char c : query_str) {
-        if (is_unreserved(c)) {
-            result += c;
-        } else if (c == ' ') {
-            result += '+';
+    serialize_runs(result, query_str, chars::unreserved, [](std::string& out, char c) {
+        if (c == ' ') {
+            out += '+';
         } else {
-            append(result, c);
+            append(out, c);
         }
-    }
+    });
 }
 
 } // namespace detail
@@ -0,0 +1,96 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/types/body_file.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace sl::http::v1 {
+namespace detail {
+
+struct body_file_state {
+    int fd;
+    std::size_t size = 0;
+
+    explicit body_file_state(int file_fd) : fd{ file_fd } {}
+    body_file_state(const body_file_state&) = delete;
+    body_file_state& operator=(const body_file_state&) = delete;
+    ~body_file_state() { ::close(fd); }
+};
+
+namespace {
+
+std::error_code last_error() { return std::error_code{ errno, std::system_category() }; }
+
+int open_unlinked(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd != -1 || (errno != EOPNOTSUPP && errno != EISDIR)) {
+        return fd;
+    }
+
+    std::string path = directory + "/sl-http-body-XXXXXX";
+    const int named_fd = ::mkostemp(path.data(), O_CLOEXEC);
+    if (named_fd != -1) {
+        ::unlink(path.c_str());
+    }
+    return named_fd;
+}
+
+} // namespace
+} // namespace detail
+
+meta::result<body_file_type, std::error_code> body_file_type::create(const std::string& directory) {
+    const int fd = detail::open_unlinked(directory);
+    if (fd == -1) {
+        return meta::err(detail::last_error());
+    }
+    return body_file_type{ std::make_shared<detail::body_file_state>(fd) };
+}
+
+std::error_code body_file_type::append(std::span<const std::byte> data) {
+    while (!data.empty()) {
+        const ssize_t written =
+            ::pwrite(state_->fd, data.data(), data.size(), static_cast<off_t>(state_->size));
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return detail::last_error();
+        }
+        state_->size += static_cast<std::size_t>(written);
+        data = data.subspan(static_cast<std::size_t>(written));
+    }
+    return {};
+}
+
+meta::result<std::size_t, std::error_code>
+    body_file_type::read(std::size_t offset, std::span<std::byte> buffer) const {
+    std::size_t total = 0;
+    while (total < buffer.size() && offset + total < state_->size) {
+        const ssize_t read_size = ::pread(
+            state_->fd, buffer.data() + total, buffer.size() - total, static_cast<off_t>(offset + total)
+        );
+        if (read_size == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return meta::err(detail::last_error());
+        }
+        if (read_size == 0) {
+            break;
+        }
+        total += static_cast<std::size_t>(read_size);
+    }
+    return total;
+}
+
+std::size_t body_file_type::size() const { return state_->size; }
+
+int body_file_type::fd() const { return state_->fd; }
+
+} // namespace sl::http::v1
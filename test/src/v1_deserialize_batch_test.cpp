@@ -0,0 +1,117 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize.hpp"
+#include "sl/http/v1/detail/strings.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace sl::http::v1 {
+namespace {
+
+// every connection logs its events into one shared array, to see how they interleave
+struct logging_handler {
+    std::size_t connection;
+    std::vector<std::string>* log;
+    std::string target{};
+
+    void on_target(std::string_view x) {
+        target = x;
+        log->push_back(std::to_string(connection) + " target " + target);
+    }
+    void on_complete() { log->push_back(std::to_string(connection) + " complete"); }
+};
+
+using batch_deserializer = basic_deserializer<logging_handler>;
+using batch_item = deserialize_batch_item<batch_deserializer>;
+
+} // namespace
+
+TEST(DeserializeBatchTest, CompletedMessages) {
+    const deserialize_config config{};
+    std::vector<std::string> log;
+    std::vector<batch_deserializer> deserializers;
+    for (std::size_t i = 0; i < 3; ++i) {
+        deserializers.push_back(make_request_deserializer(logging_handler{ i, &log }, config));
+    }
+
+    const std::string first = "GET /0 HTTP/1.1\r\n\r\nGET /00 HTTP/1.1\r\n\r\n";
+    const std::string second = "POST /1 HTTP/1.1\r\nContent-Length: 5\r\n\r\nab";
+    const std::string third = "GET /2 HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    std::vector<batch_item> items{
+        { .deserializer = &deserializers[0], .input = detail::buffer_str_to_byte(first) },
+        { .deserializer = &deserializers[1], .input = detail::buffer_str_to_byte(second) },
+        { .deserializer = &deserializers[2], .input = detail::buffer_str_to_byte(third) },
+    };
+    deserialize_batch<batch_deserializer> batch;
+    const auto completed = batch(items);
+    EXPECT_EQ(std::vector(completed.begin(), completed.end()), (std::vector<std::size_t>{ 0, 2, 0 }));
+    for (const auto& item : items) {
+        EXPECT_FALSE(item.error.has_value());
+        EXPECT_TRUE(item.input.empty());
+    }
+    // one event per connection and turn
+    EXPECT_EQ(log.front(), "0 target /0");
+    EXPECT_EQ(log[1], "1 target /1");
+    EXPECT_EQ(log[2], "2 target /2");
+
+    // the rest of the body arrives on the next wakeup
+    const std::string second_rest = "cde";
+    std::vector<batch_item> next_items{
+        { .deserializer = &deserializers[1], .input = detail::buffer_str_to_byte(second_rest) },
+    };
+    const auto next_completed = batch(next_items);
+    EXPECT_EQ(std::vector(next_completed.begin(), next_completed.end()), (std::vector<std::size_t>{ 0 }));
+    EXPECT_EQ(log.back(), "1 complete");
+}
+
+TEST(DeserializeBatchTest, FailureIsPerConnection) {
+    const deserialize_config config{};
+    std::vector<std::string> log;
+    auto bad = make_request_deserializer(logging_handler{ 0, &log }, config);
+    auto good = make_request_deserializer(logging_handler{ 1, &log }, config);
+
+    const std::string bad_input = "BREW /pot HTTP/1.1\r\n\r\n";
+    const std::string good_input = "GET / HTTP/1.1\r\n\r\n";
+    std::vector<batch_item> items{
+        { .deserializer = &bad, .input = detail::buffer_str_to_byte(bad_input) },
+        { .deserializer = &good, .input = detail::buffer_str_to_byte(good_input) },
+    };
+    deserialize_batch<batch_deserializer> batch;
+    const auto completed = batch(items);
+    ASSERT_TRUE(items[0].error.has_value());
+    EXPECT_EQ(items[0].error.value(), status_type::BAD_REQUEST);
+    EXPECT_FALSE(items[1].error.has_value());
+    EXPECT_EQ(std::vector(completed.begin(), completed.end()), (std::vector<std::size_t>{ 1 }));
+}
+
+TEST(DeserializeBatchTest, SameEventsAsSequential) {
+    const deserialize_config config{};
+    const std::string input = "POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n"
+                              "GET /b HTTP/1.1\r\n\r\n";
+
+    std::vector<std::string> sequential;
+    auto sequential_deserializer = make_request_deserializer(logging_handler{ 0, &sequential }, config);
+    ASSERT_FALSE(sequential_deserializer(detail::buffer_str_to_byte(input)).has_value());
+
+    std::vector<std::string> batched;
+    auto batched_deserializer = make_request_deserializer(logging_handler{ 0, &batched }, config);
+    deserialize_batch<batch_deserializer> batch;
+    std::size_t completed_count = 0;
+    // byte by byte, one wakeup each, so the remainder is buffered in between
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        std::vector<batch_item> items{
+            { .deserializer = &batched_deserializer, .input = detail::buffer_str_to_byte(input).subspan(i, 1) },
+        };
+        completed_count += batch(items).size();
+        ASSERT_FALSE(items[0].error.has_value());
+    }
+    EXPECT_EQ(batched, sequential);
+    EXPECT_EQ(completed_count, 2);
+}
+
+} // namespace sl::http::v1
@@ -0,0 +1,165 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/packed.hpp"
+#include "sl/http/v1/detail/strings.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace sl::http::v1 {
+
+TEST(PackedTest, RequestSpans) {
+    const std::string_view first =
+        "POST /a%20b?x=1&y=%41 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Accept: text/html\r\n"
+        "accept: application/json\r\n"
+        "Content-Length: 3\r\n"
+        "\r\n"
+        "abc";
+    const std::string input = std::string{ first } + "GET /b HTTP/1.1\r\n\r\n";
+
+    const auto result = parse_packed_request(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(result.has_value() && result.value().has_value());
+    const auto& [message, offset] = result.value().value();
+    EXPECT_EQ(offset, first.size());
+    EXPECT_TRUE(message.is_request());
+    EXPECT_EQ(message.method(), method_type::POST);
+    EXPECT_EQ(message.version(), version_type::HTTPv1_1);
+    EXPECT_EQ(message.raw_target(), "/a%20b?x=1&y=%41");
+
+    const auto origin = message.origin_target();
+    ASSERT_TRUE(origin.has_value());
+    EXPECT_EQ(origin.value().path, "/a b");
+    EXPECT_EQ(origin.value().query.raw(), "x=1&y=%41");
+    std::array<char, 8> query_buffer{};
+    EXPECT_EQ(origin.value().query.find("y", query_buffer), std::string_view{ "A" });
+
+    ASSERT_EQ(message.fields().size(), 4);
+    EXPECT_EQ(message.view(message.fields()[0].name), "Host");
+    EXPECT_EQ(message.find_field("host"), std::string_view{ "example.com" });
+    EXPECT_EQ(message.find_field("accept"), std::string_view{ "text/html" });
+    EXPECT_FALSE(message.find_field("cookie").has_value());
+    EXPECT_EQ(detail::buffer_byte_to_str(message.body()), "abc");
+    EXPECT_EQ(message.framing().content_length, 3);
+    // the head is kept as received
+    EXPECT_TRUE(message.buffer().starts_with(first.substr(0, first.find("abc"))));
+
+    const auto next = parse_packed_request(detail::buffer_str_to_byte(input).subspan(offset));
+    ASSERT_TRUE(next.has_value() && next.value().has_value());
+    EXPECT_EQ(next.value().value().message.origin_target().value().path, "/b");
+    EXPECT_TRUE(next.value().value().message.origin_target().value().query.empty());
+}
+
+TEST(PackedTest, SameMessageAsParse) {
+    const std::string_view input =
+        "PUT /upload?name=file HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Accept: text/html\r\n"
+        "Accept: application/json\r\n"
+        "\r\n"
+        "5;ext\r\nhello\r\n"
+        "6\r\n world\r\n"
+        "0\r\n"
+        "X-Checksum: abc\r\n"
+        "\r\n";
+
+    const auto parsed = parse_request(detail::buffer_str_to_byte(input));
+    const auto packed = parse_packed_request(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(parsed.has_value());
+    ASSERT_TRUE(packed.has_value() && packed.value().has_value());
+    EXPECT_EQ(packed.value().value().offset, parsed.value().offset);
+    EXPECT_EQ(packed.value().value().message.find_field("x-checksum"), std::string_view{ "abc" });
+
+    const message_type& expected = parsed.value().message;
+    const message_type message = packed.value().value().message.to_message();
+    EXPECT_EQ(message.fields, expected.fields);
+    EXPECT_EQ(detail::buffer_byte_to_str(message.body), "hello world");
+    EXPECT_EQ(message.body, expected.body);
+    const auto& request_line = std::get<request_line_type>(message.start_line);
+    const auto& expected_request_line = std::get<request_line_type>(expected.start_line);
+    EXPECT_EQ(request_line.method, expected_request_line.method);
+    EXPECT_EQ(request_line.version, expected_request_line.version);
+    EXPECT_EQ(
+        std::get<origin_target_type>(request_line.target).path,
+        std::get<origin_target_type>(expected_request_line.target).path
+    );
+    EXPECT_EQ(
+        std::get<origin_target_type>(request_line.target).query,
+        std::get<origin_target_type>(expected_request_line.target).query
+    );
+    EXPECT_TRUE(message.framing.is_chunked);
+}
+
+TEST(PackedTest, Response) {
+    const std::string_view input = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    const auto result = parse_packed_response(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(result.has_value() && result.value().has_value());
+    const auto& message = result.value().value().message;
+    EXPECT_FALSE(message.is_request());
+    EXPECT_EQ(message.status(), status_type::NOT_FOUND);
+    EXPECT_EQ(message.reason(), "Not Found");
+    EXPECT_TRUE(message.body().empty());
+
+    const message_type materialized = message.to_message();
+    EXPECT_EQ(std::get<response_line_type>(materialized.start_line).reason, "Not Found");
+    EXPECT_EQ(materialized.fields.at("content-length"), "0");
+}
+
+TEST(PackedTest, OtherTargetForms) {
+    const std::string_view input = "OPTIONS * HTTP/1.1\r\n\r\n";
+    const auto result = parse_packed_request(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(result.has_value() && result.value().has_value());
+    EXPECT_FALSE(result.value().value().message.origin_target().has_value());
+    EXPECT_TRUE(std::holds_alternative<asterisk_target_type>(
+        std::get<request_line_type>(result.value().value().message.to_message().start_line).target
+    ));
+
+    for (const std::string_view invalid : { "GET /a%zz HTTP/1.1\r\n\r\n", "GET ftp://x HTTP/1.1\r\n\r\n" }) {
+        const auto invalid_result = parse_packed_request(detail::buffer_str_to_byte(invalid));
+        ASSERT_FALSE(invalid_result.has_value()) << invalid;
+        EXPECT_EQ(invalid_result.error(), status_type::BAD_REQUEST) << invalid;
+    }
+}
+
+TEST(PackedTest, RetainedFieldsAndIncomplete) {
+    const std::string_view input = "GET / HTTP/1.1\r\nHost: example.com\r\nCookie: a=b\r\n\r\n";
+    const deserialize_config retaining{ .retained_fields = field_names_type{ "host" } };
+    const auto retained = parse_packed_request(detail::buffer_str_to_byte(input), retaining);
+    ASSERT_TRUE(retained.has_value() && retained.value().has_value());
+    ASSERT_EQ(retained.value().value().message.fields().size(), 1);
+    EXPECT_FALSE(retained.value().value().message.find_field("cookie").has_value());
+
+    // cut anywhere, the message is incomplete rather than malformed
+    for (std::size_t size = 0; size < input.size(); ++size) {
+        const auto incomplete = parse_packed_request(detail::buffer_str_to_byte(input.substr(0, size)));
+        ASSERT_TRUE(incomplete.has_value()) << size;
+        EXPECT_FALSE(incomplete.value().has_value()) << size;
+    }
+    const auto malformed = parse_packed_request(detail::buffer_str_to_byte("GET / HTTP/1.1\r\nHost example.com\r\n"));
+    ASSERT_FALSE(malformed.has_value());
+    EXPECT_EQ(malformed.error(), status_type::BAD_REQUEST);
+}
+
+TEST(PackedTest, InputTooLarge) {
+    // rejected before any byte is read, so the mapping is never backed
+    const std::size_t size = std::numeric_limits<std::uint32_t>::max() / 2 + 1;
+    void* const data = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    ASSERT_NE(data, MAP_FAILED);
+    const auto result = parse_packed_request(std::span{ static_cast<const std::byte*>(data), size });
+    ::munmap(data, size);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), status_type::CONTENT_TOO_LARGE);
+}
+
+} // namespace sl::http::v1
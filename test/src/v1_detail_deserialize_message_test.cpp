@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <exception>
 #include <fmt/core.h>
 #include <variant>
@@ -88,15 +89,20 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
             .message_cb = [&](message_type msg) { result.message = std::move(msg); },
+            .retained_fields = base_config.retained_fields,
             .max_body_size = base_config.max_body_size,
             .max_field_size = base_config.max_field_size,
+            .max_field_count = base_config.max_field_count,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_request(std::move(config));
         result.error = deserializer(detail::buffer_str_to_byte(input));
@@ -109,15 +115,20 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
             .message_cb = [&](message_type msg) { result.message = std::move(msg); },
+            .retained_fields = base_config.retained_fields,
             .max_body_size = base_config.max_body_size,
             .max_field_size = base_config.max_field_size,
+            .max_field_count = base_config.max_field_count,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_request(std::move(config));
         auto bytes = detail::buffer_str_to_byte(input);
@@ -136,7 +147,7 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
@@ -145,6 +156,9 @@ protected:
             .max_field_size = base_config.max_field_size,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_response(std::move(config));
         result.error = deserializer(detail::buffer_str_to_byte(input));
@@ -157,7 +171,7 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
@@ -166,6 +180,9 @@ protected:
             .max_field_size = base_config.max_field_size,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_response(std::move(config));
         auto bytes = detail::buffer_str_to_byte(input);
@@ -195,7 +212,7 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.current_chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
@@ -208,6 +225,9 @@ protected:
             .max_field_size = base_config.max_field_size,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_request(std::move(config));
         result.error = deserializer(detail::buffer_str_to_byte(input));
@@ -220,7 +240,7 @@ protected:
         deserialize_config config{
             .chunk_cb = [&](message_chunk chunk) {
                 result.current_chunks.push_back(stored_chunk{
-                    .chunk_ext = std::move(chunk.chunk_ext),
+                    .chunk_ext = std::string{ chunk.chunk_ext },
                     .chunk = std::vector<std::byte>(chunk.chunk.begin(), chunk.chunk.end()),
                 });
             },
@@ -233,6 +253,9 @@ protected:
             .max_field_size = base_config.max_field_size,
             .max_reason_size = base_config.max_reason_size,
             .max_target_size = base_config.max_target_size,
+            .coalesced_chunk_size = base_config.coalesced_chunk_size,
+            .body_spill_size = base_config.body_spill_size,
+            .body_spill_directory = base_config.body_spill_directory,
         };
         auto deserializer = make_deserialize_request(std::move(config));
         auto bytes = detail::buffer_str_to_byte(input);
@@ -480,6 +503,37 @@ TEST_F(DeserializeRequestTest, OneByOneInputWithChunkExtensions) {
     EXPECT_EQ(collect_chunk_exts(result.chunks).front(), "ext=value");
 }
 
+TEST_F(DeserializeRequestTest, CoalescedChunks) {
+    const std::string_view input = "POST /upload HTTP/1.1\r\n"
+                                   "Transfer-Encoding: chunked\r\n\r\n"
+                                   "3\r\nabc\r\n3\r\ndef\r\n3\r\nghi\r\n"
+                                   "8\r\n01234567\r\n"
+                                   "2;ext=value\r\njk\r\n"
+                                   "1\r\nl\r\n0\r\n\r\n";
+    auto result = drain_request_full(input, deserialize_config{ .coalesced_chunk_size = 8 });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(collect_chunks(result.chunks), detail::buffer_str_to_byte("abcdefghi01234567jkl"));
+
+    std::vector<std::string> deliveries;
+    for (const auto& chunk : result.chunks) {
+        deliveries.push_back(chunk.chunk_ext + ":" + std::string{ detail::buffer_byte_to_str(chunk.chunk) });
+    }
+    // bounded by 8, an extension or the last-chunk ends a merge
+    const std::vector<std::string> expected{ ":abcdef", ":ghi", ":01234567", "ext=value:jk", ":l", ":" };
+    EXPECT_EQ(deliveries, expected);
+}
+
+TEST_F(DeserializeRequestTest, CoalescedChunksOnlyWithinInput) {
+    const std::string_view input = "POST /upload HTTP/1.1\r\n"
+                                   "Transfer-Encoding: chunked\r\n\r\n"
+                                   "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n";
+    auto result = drain_request_one_by_one(input, deserialize_config{ .coalesced_chunk_size = 1024 });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(collect_chunks(result.chunks), detail::buffer_str_to_byte("abcdef"));
+    // every chunk completes in its own input, nothing is held back for the next one
+    EXPECT_EQ(result.chunks.size(), 3);
+}
+
 TEST_F(DeserializeRequestTest, CaseInsensitiveHeaders) {
     auto result =
         drain_request_full("GET / HTTP/1.1\r\nHOST: example.com\r\nUser-Agent: Test\r\naccept: */*\r\n\r\n");
@@ -533,6 +587,367 @@ TEST_F(DeserializeRequestTest, ContentLengthWithinMaxBodySize) {
     EXPECT_EQ(result->body, detail::buffer_str_to_byte("Hello, World!"));
 }
 
+TEST_F(DeserializeRequestTest, BodySpill) {
+    const std::string body(100, 'x');
+    const std::string input =
+        "POST /upload HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    const deserialize_config config{ .body_spill_size = 64 };
+
+    for (const auto& result : { drain_request_full(input, config), drain_request_one_by_one(input, config) }) {
+        ASSERT_TRUE(result.has_value());
+        EXPECT_TRUE(result->body.empty());
+        ASSERT_TRUE(result->body_file.has_value());
+        const auto& body_file = result->body_file.value();
+        EXPECT_EQ(body_file.size(), body.size());
+
+        std::string read_back(body.size() + 1, '\0');
+        const auto read_result = body_file.read(0, std::as_writable_bytes(std::span{ read_back }));
+        ASSERT_TRUE(read_result.has_value());
+        EXPECT_EQ(read_result.value(), body.size());
+        read_back.resize(read_result.value());
+        EXPECT_EQ(read_back, body);
+    }
+}
+
+TEST_F(DeserializeRequestTest, BodyBelowSpillSizeInMemory) {
+    const deserialize_config config{ .body_spill_size = 64 };
+    auto result = drain_request_full("POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nHello", config);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FALSE(result->body_file.has_value());
+    EXPECT_EQ(result->body, detail::buffer_str_to_byte("Hello"));
+}
+
+TEST_F(DeserializeRequestTest, BodySpillFailure) {
+    const deserialize_config config{ .body_spill_size = 1, .body_spill_directory = "/nonexistent" };
+    auto result = drain_request_full("POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nHello", config);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error, status_type::INTERNAL_SERVER_ERROR);
+}
+
+// === Framing ===
+
+TEST_F(DeserializeRequestTest, FramingDecodedFromFields) {
+    auto result = drain_request_full(
+        "POST /upload HTTP/1.1\r\n"
+        "Content-Length: 5\r\n"
+        "Connection: Keep-Alive, Upgrade\r\n"
+        "Upgrade: websocket\r\n"
+        "Expect: 100-Continue\r\n"
+        "\r\n"
+        "Hello"
+    );
+    ASSERT_TRUE(result.has_value());
+    const auto& framing = result->framing;
+    EXPECT_EQ(framing.content_length.value_or(0), 5);
+    EXPECT_FALSE(framing.has_transfer_encoding);
+    EXPECT_FALSE(framing.is_chunked);
+    EXPECT_FALSE(framing.has_connection_close);
+    EXPECT_TRUE(framing.has_connection_keep_alive);
+    EXPECT_TRUE(framing.has_connection_upgrade);
+    EXPECT_TRUE(framing.has_upgrade);
+    EXPECT_EQ(framing.expect, expect_type::CONTINUE);
+}
+
+TEST_F(DeserializeRequestTest, FramingChunkedNotTakenFromTrailers) {
+    auto result = drain_request_full(
+        "POST /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: gzip, chunked\r\n"
+        "\r\n"
+        "5\r\nHello\r\n0\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+    );
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->framing.has_transfer_encoding);
+    EXPECT_TRUE(result->framing.is_chunked);
+    EXPECT_FALSE(result->framing.has_connection_close);
+}
+
+TEST_F(DeserializeRequestTest, FramingUnknownExpectation) {
+    auto result = drain_request_full("GET / HTTP/1.1\r\nExpect: 100-continue, something-else\r\n\r\n");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->framing.expect, expect_type::UNKNOWN);
+}
+
+TEST_F(DeserializeRequestTest, FramingRepeatedContentLength) {
+    auto result = drain_request_full(
+        "POST / HTTP/1.1\r\nContent-Length: 5, 5\r\nContent-Length: 5\r\n\r\nHello"
+    );
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->body, detail::buffer_str_to_byte("Hello"));
+}
+
+TEST_F(DeserializeRequestTest, ConnectionVerdict) {
+    const auto verdict = [this](std::string_view input) {
+        auto result = drain_request_full(input);
+        EXPECT_TRUE(result.has_value()) << input;
+        return result.has_value() ? result->framing.connection : connection_type::UNSPECIFIED;
+    };
+    EXPECT_EQ(verdict("GET / HTTP/1.1\r\n\r\n"), connection_type::KEEP_ALIVE);
+    EXPECT_EQ(verdict("GET / HTTP/1.0\r\n\r\n"), connection_type::CLOSE);
+    EXPECT_EQ(verdict("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"), connection_type::KEEP_ALIVE);
+    EXPECT_EQ(verdict("GET / HTTP/1.1\r\nConnection: keep-alive, CLOSE\r\n\r\n"), connection_type::CLOSE);
+    EXPECT_EQ(verdict("GET / HTTP/1.1\r\nConnection: upgrade\r\nUpgrade: h2c\r\n\r\n"), connection_type::UPGRADE);
+    // upgrade option without the Upgrade field is meaningless
+    EXPECT_EQ(verdict("GET / HTTP/1.1\r\nConnection: upgrade\r\n\r\n"), connection_type::KEEP_ALIVE);
+}
+
+TEST_F(DeserializeRequestTest, FramingInvalid) {
+    for (const std::string_view input : {
+             "POST / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n",
+             "POST / HTTP/1.1\r\nContent-Length: 5, 6\r\n\r\n",
+             "POST / HTTP/1.1\r\nContent-Length: five\r\n\r\n",
+             "POST / HTTP/1.1\r\nContent-Length: -5\r\n\r\n",
+             "POST / HTTP/1.1\r\nContent-Length:\r\n\r\n",
+             "POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n",
+             "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n",
+             "POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n",
+             "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n",
+             "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+         }) {
+        auto result = drain_request_full(input);
+        EXPECT_FALSE(result.has_value()) << input;
+        EXPECT_EQ(result.error, status_type::BAD_REQUEST) << input;
+    }
+}
+
+TEST_F(DeserializeRequestTest, MalformedFieldLine) {
+    for (const std::string_view input : {
+             "GET / HTTP/1.1\r\nHost example.com\r\n\r\n",
+             "GET / HTTP/1.1\r\nHost : example.com\r\n\r\n",
+             "GET / HTTP/1.1\r\n Host: example.com\r\n\r\n",
+             "GET / HTTP/1.1\r\n: example.com\r\n\r\n",
+             "GET / HTTP/1.1\r\nHo(st: example.com\r\n\r\n",
+             "GET / HTTP/1.1\r\nHost: example.com\r\n\rX",
+         }) {
+        auto result = drain_request_full(input);
+        EXPECT_FALSE(result.has_value()) << input;
+        EXPECT_EQ(result.error, status_type::BAD_REQUEST) << input;
+    }
+}
+
+// === Headers ===
+
+TEST_F(DeserializeRequestTest, HeadersRejectBeforeBody) {
+    bool is_message_received = false;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [](message_chunk) {},
+        .message_cb = [&](message_type) { is_message_received = true; },
+        .headers_cb =
+            [](const message_type& msg) -> meta::result<body_mode, status_type> {
+            EXPECT_EQ(get_origin_path(get_request_line(msg).target), "/admin");
+            EXPECT_FALSE(msg.fields.contains("authorization"));
+            return meta::err(status_type::UNAUTHORIZED);
+        },
+    });
+
+    // body is not even here yet
+    const std::string_view head = "POST /admin HTTP/1.1\r\nContent-Length: 1000000\r\n\r\n";
+    EXPECT_EQ(deserializer(detail::buffer_str_to_byte(head)), status_type::UNAUTHORIZED);
+    EXPECT_FALSE(is_message_received);
+}
+
+TEST_F(DeserializeRequestTest, HeadersStreamContentLength) {
+    std::vector<std::string> pieces;
+    std::vector<message_type> messages;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [&](message_chunk chunk) { pieces.emplace_back(detail::buffer_byte_to_str(chunk.chunk)); },
+        .message_cb = [&](message_type msg) { messages.push_back(std::move(msg)); },
+        .headers_cb = [](const message_type&) -> meta::result<body_mode, status_type> { return body_mode::STREAM; },
+    });
+
+    for (const std::string_view part : { "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nHello", ", Wor", "ld" }) {
+        ASSERT_FALSE(deserializer(detail::buffer_str_to_byte(part)).has_value());
+    }
+    EXPECT_EQ(pieces, (std::vector<std::string>{ "Hello", ", Wor" }));
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_TRUE(messages[0].body.empty());
+}
+
+TEST_F(DeserializeRequestTest, HeadersDiscard) {
+    std::size_t chunk_count = 0;
+    std::vector<message_type> messages;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [&](message_chunk) { ++chunk_count; },
+        .message_cb = [&](message_type msg) { messages.push_back(std::move(msg)); },
+        .headers_cb =
+            [](const message_type& msg) -> meta::result<body_mode, status_type> {
+            return get_origin_path(get_request_line(msg).target) == "/drop" ? body_mode::DISCARD : body_mode::BUFFER;
+        },
+    });
+
+    const std::string_view input = "POST /drop HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nHello\r\n0\r\n\r\n"
+                                   "POST /drop HTTP/1.1\r\nContent-Length: 5\r\n\r\nHello"
+                                   "POST /keep HTTP/1.1\r\nContent-Length: 5\r\n\r\nHello";
+    ASSERT_FALSE(deserializer(detail::buffer_str_to_byte(input)).has_value());
+    EXPECT_EQ(chunk_count, 0);
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_TRUE(messages[0].body.empty());
+    EXPECT_TRUE(messages[1].body.empty());
+    EXPECT_EQ(messages[2].body, detail::buffer_str_to_byte("Hello"));
+}
+
+TEST_F(DeserializeRequestTest, MaxFieldCount) {
+    const deserialize_config config{ .max_field_count = 3 };
+    const auto make_input = [](std::size_t field_count) {
+        std::string input = "GET / HTTP/1.1\r\n";
+        for (std::size_t i = 0; i < field_count; ++i) {
+            input += fmt::format("x-{}: v\r\n", i);
+        }
+        return input + "\r\n";
+    };
+
+    auto within = drain_request_full(make_input(3), config);
+    ASSERT_TRUE(within.has_value());
+    EXPECT_EQ(within->fields.size(), 3);
+
+    for (const auto& result : { drain_request_full(make_input(4), config), drain_request_one_by_one(make_input(4), config) }) {
+        EXPECT_FALSE(result.has_value());
+        EXPECT_EQ(result.error, status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+    }
+}
+
+TEST_F(DeserializeRequestTest, MaxFieldCountTrailers) {
+    const deserialize_config config{ .max_field_count = 1 };
+    auto result = drain_request_full(
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "0\r\nx-a: 1\r\nx-b: 2\r\n\r\n",
+        config
+    );
+    EXPECT_EQ(result.error, status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+}
+
+// === Retained fields ===
+
+TEST_F(DeserializeRequestTest, RetainedFieldsOnly) {
+    const deserialize_config config{ .retained_fields = field_names_type{ "host", "X-Request-Id" } };
+    const std::string_view input = "POST / HTTP/1.1\r\n"
+                                   "HOST: example.com\r\n"
+                                   "User-Agent: curl\r\n"
+                                   "x-request-id: 42\r\n"
+                                   "Accept: */*\r\n"
+                                   "Content-Length: 5\r\n"
+                                   "\r\n"
+                                   "Hello";
+    for (const auto& result : { drain_request_full(input, config), drain_request_one_by_one(input, config) }) {
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result->fields.size(), 3);
+        EXPECT_EQ(result->fields.at("host"), "example.com");
+        EXPECT_EQ(result->fields.at("x-request-id"), "42");
+        EXPECT_EQ(result->fields.at("content-length"), "5"); // framing is always retained
+        EXPECT_EQ(result->body, detail::buffer_str_to_byte("Hello"));
+    }
+}
+
+TEST_F(DeserializeRequestTest, RetainedFieldsTrailers) {
+    const deserialize_config config{ .retained_fields = field_names_type{ "x-checksum" } };
+    auto result = drain_request_full(
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "0\r\nX-Checksum: abc\r\nX-Other: def\r\n\r\n",
+        config
+    );
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->fields.at("x-checksum"), "abc");
+    EXPECT_FALSE(result->fields.contains("x-other"));
+}
+
+TEST_F(DeserializeRequestTest, RetainedFieldsSkippedStillValidated) {
+    const deserialize_config config{ .retained_fields = field_names_type{ "host" }, .max_field_size = 64 };
+    auto invalid = drain_request_full("GET / HTTP/1.1\r\nno colon here\r\n\r\n", config);
+    EXPECT_EQ(invalid.error, status_type::BAD_REQUEST);
+
+    auto too_large =
+        drain_request_full(fmt::format("GET / HTTP/1.1\r\nx-skipped: {}\r\n\r\n", std::string(64, 'a')), config);
+    EXPECT_EQ(too_large.error, status_type::CONTENT_TOO_LARGE);
+}
+
+// === Expect ===
+
+TEST_F(DeserializeRequestTest, ExpectContinuePausesBeforeBody) {
+    std::vector<std::string> events;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [](message_chunk) {},
+        .message_cb = [&](message_type msg) { events.emplace_back(detail::buffer_byte_to_str(msg.body)); },
+        .expect_cb =
+            [&](const message_type& msg) -> meta::maybe<status_type> {
+            EXPECT_TRUE(msg.body.empty());
+            EXPECT_EQ(msg.fields.at("content-length"), "5");
+            events.emplace_back("expect");
+            return meta::null;
+        },
+    });
+
+    const std::string_view head = "PUT /file HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 5\r\n\r\n";
+    ASSERT_FALSE(deserializer(detail::buffer_str_to_byte(head)).has_value());
+    ASSERT_EQ(events, std::vector<std::string>{ "expect" });
+
+    ASSERT_FALSE(deserializer(detail::buffer_str_to_byte("Hello")).has_value());
+    EXPECT_EQ(events, (std::vector<std::string>{ "expect", "Hello" }));
+}
+
+TEST_F(DeserializeRequestTest, ExpectContinueRejected) {
+    bool is_message_received = false;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [](message_chunk) {},
+        .message_cb = [&](message_type) { is_message_received = true; },
+        .expect_cb = [](const message_type&) -> meta::maybe<status_type> { return status_type::CONTENT_TOO_LARGE; },
+    });
+
+    const auto error = deserializer(detail::buffer_str_to_byte(
+        "POST /upload HTTP/1.1\r\nExpect: 100-continue\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nHello\r\n"
+    ));
+    EXPECT_EQ(error, status_type::CONTENT_TOO_LARGE);
+    EXPECT_FALSE(is_message_received);
+}
+
+TEST_F(DeserializeRequestTest, ExpectWithoutBodyIgnored) {
+    bool is_expect_called = false;
+    bool is_message_received = false;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [](message_chunk) {},
+        .message_cb = [&](message_type) { is_message_received = true; },
+        .expect_cb =
+            [&](const message_type&) -> meta::maybe<status_type> {
+            is_expect_called = true;
+            return meta::null;
+        },
+    });
+
+    const std::string_view input = "GET / HTTP/1.1\r\nExpect: 100-continue\r\n\r\n";
+    EXPECT_FALSE(deserializer(detail::buffer_str_to_byte(input)).has_value());
+    EXPECT_FALSE(is_expect_called);
+    EXPECT_TRUE(is_message_received);
+}
+
+TEST_F(DeserializeRequestTest, ExpectContinueIgnoredForHttp10) {
+    bool is_expect_called = false;
+    std::vector<std::string> bodies;
+    auto deserializer = make_deserialize_request(deserialize_config{
+        .chunk_cb = [](message_chunk) {},
+        .message_cb =
+            [&](message_type msg) {
+                EXPECT_EQ(msg.framing.expect, expect_type::NONE);
+                bodies.emplace_back(detail::buffer_byte_to_str(msg.body));
+            },
+        .expect_cb =
+            [&](const message_type&) -> meta::maybe<status_type> {
+            is_expect_called = true;
+            return meta::null;
+        },
+    });
+
+    const std::string_view input = "PUT /file HTTP/1.0\r\nExpect: 100-continue\r\nContent-Length: 5\r\n\r\nHello";
+    EXPECT_FALSE(deserializer(detail::buffer_str_to_byte(input)).has_value());
+    EXPECT_FALSE(is_expect_called);
+    EXPECT_EQ(bodies, std::vector<std::string>{ "Hello" });
+}
+
+TEST_F(DeserializeRequestTest, ExpectUnknown) {
+    auto result = drain_request_full("PUT / HTTP/1.1\r\nExpect: 200-ok\r\nContent-Length: 5\r\n\r\nHello");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error, status_type::EXPECTATION_FAILED);
+}
+
 // Pipelining test disabled - API changed from async_gen to callback-based state machine.
 // Pipelined request with trailing fields followed by another request
 TEST_F(DeserializeRequestTest, PipelinedRequestsWithTrailingFields) {
@@ -563,12 +978,11 @@ TEST_F(DeserializeRequestTest, PipelinedRequestsWithTrailingFields) {
 }
 
 TEST_F(DeserializeRequestTest, TrailingFieldsCRLFOffset) {
-    // Direct test of deserialize_machine::deserialize_impl offset when trailing fields end.
+    // Direct test of deserialize_core::deserialize_impl offset when trailing fields end.
     // When empty field line (CRLF) detected in trailing_fields state,
     // returned offset must be 2 to consume the CRLF bytes.
 
-    message_type output;
-    output.start_line = request_line_type{};
+    detail::deserialize_context context{ .is_request = true };
     deserialize_config config{
         .chunk_cb = [](message_chunk) {},
         .message_cb = [](message_type) {},
@@ -581,16 +995,55 @@ TEST_F(DeserializeRequestTest, TrailingFieldsCRLFOffset) {
     const std::string_view input = "\r\nGET / HTTP/1.1\r\n"; // CRLF + next request
     const auto buffer = detail::buffer_str_to_byte(input);
 
-    const auto result = detail::deserialize_machine::deserialize_impl(output, state, config, buffer);
+    const auto result = detail::deserialize_core::deserialize_impl(context, state, config, buffer);
 
     ASSERT_TRUE(result.has_value()) << "Should parse successfully";
-    EXPECT_TRUE(std::holds_alternative<detail::deserialize_state_complete>(result.value().state))
+    EXPECT_TRUE(result.value().state.is<detail::deserialize_state_complete>())
         << "Should transition to complete state";
 
     // Offset must be 2 to consume CRLF, otherwise pipelining breaks
     EXPECT_EQ(result.value().offset, 2u) << "Must consume CRLF (2 bytes) for correct pipelining";
 }
 
+TEST_F(DeserializeRequestTest, StateRoundTrip) {
+    const detail::deserialize_state fields = detail::deserialize_state_fields{ .consumed_bytes = 7, .field_count = 3 };
+    EXPECT_EQ(fields.kind(), detail::deserialize_state_kind::FIELDS);
+    EXPECT_FALSE(fields.is<detail::deserialize_state_trailing_fields>());
+    EXPECT_EQ(fields.as<detail::deserialize_state_fields>().consumed_bytes, 7);
+    EXPECT_EQ(fields.as<detail::deserialize_state_fields>().field_count, 3);
+
+    const detail::deserialize_state expect = detail::deserialize_state_expect{ .content_length_left = 5 };
+    EXPECT_EQ(expect.as<detail::deserialize_state_expect>().content_length_left, 5);
+    EXPECT_FALSE(expect.as<detail::deserialize_state_expect>().is_chunked);
+
+    const detail::deserialize_state line = detail::deserialize_state_chunked_body_line{ .chunk_size = 0xFFFF'FFFF };
+    EXPECT_EQ(line.as<detail::deserialize_state_chunked_body_line>().chunk_size, 0xFFFF'FFFF);
+}
+
+TEST_F(DeserializeRequestTest, ChunkedBodyLineDirect) {
+    detail::deserialize_context context{ .is_request = true };
+    const deserialize_config config{};
+    const auto buffer = detail::buffer_str_to_byte("Hello\r\n5\r\n");
+
+    const auto result = detail::deserialize_core::deserialize_impl(
+        context, detail::deserialize_state_chunked_body_line{ .chunk_size = 5 }, config, buffer
+    );
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result.value().state.is<detail::deserialize_state_chunked_body_empty>());
+    EXPECT_EQ(result.value().offset, 7u);
+    const auto* body = std::get_if<detail::deserialize_event_body>(&result.value().event);
+    ASSERT_NE(body, nullptr);
+    EXPECT_EQ(detail::buffer_byte_to_str(body->body), "Hello");
+
+    // the same step through the flat dispatch
+    const auto step_result = detail::deserialize_core::deserialize_step(
+        context, detail::deserialize_state_chunked_body_line{ .chunk_size = 5 }, config, buffer.subspan(0, 6)
+    );
+    ASSERT_TRUE(step_result.has_value());
+    EXPECT_EQ(step_result.value().offset, 0u) << "has to wait for CRLF";
+    EXPECT_TRUE(step_result.value().state.is<detail::deserialize_state_chunked_body_line>());
+}
+
 // === Pipelining Tests ===
 // HTTP/1.1 pipelining: multiple requests in single connection, responses in order.
 
@@ -922,4 +1375,282 @@ TEST_F(DeserializeResponseTest, Redirect301) {
     EXPECT_EQ(result->fields.at("location"), "https://example.com/new");
 }
 
+// === Handler (event) mode ===
+
+struct recording_handler {
+    std::vector<std::string>* events;
+
+    void on_method(method_type method) { events->push_back(fmt::format("method:{}", enum_to_str(method))); }
+    void on_target(std::string_view target) { events->push_back(fmt::format("target:{}", target)); }
+    void on_field(std::string_view name, std::string_view value) {
+        events->push_back(fmt::format("field:{}={}", name, value));
+    }
+    void on_headers(const framing_type& framing) {
+        events->push_back(fmt::format("headers:chunked={}", framing.is_chunked));
+    }
+    void on_chunk_ext(std::string_view chunk_ext) { events->push_back(fmt::format("ext:{}", chunk_ext)); }
+    void on_body(std::span<const std::byte> body) {
+        events->push_back(fmt::format("body:{}", detail::buffer_byte_to_str(body)));
+    }
+    void on_trailer(std::string_view name, std::string_view value) {
+        events->push_back(fmt::format("trailer:{}={}", name, value));
+    }
+    void on_complete() { events->push_back("complete"); }
+};
+
+TEST(DeserializeHandlerTest, EventOrder) {
+    std::vector<std::string> events;
+    auto deserialize = make_deserialize_request(recording_handler{ &events }, deserialize_config{});
+
+    const std::string_view input =
+        "POST /upload HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;name=value\r\nhello\r\n"
+        "0\r\n"
+        "X-Checksum: abc\r\n"
+        "\r\n";
+    // byte by byte, events must not depend on how input is split
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        ASSERT_FALSE(deserialize(detail::buffer_str_to_byte(input.substr(i, 1))).has_value());
+    }
+
+    const std::vector<std::string> expected{
+        "method:POST",
+        "target:/upload",
+        "field:Host=example.com",
+        "field:Transfer-Encoding=chunked",
+        "headers:chunked=true",
+        "ext:name=value",
+        "body:hello",
+        "ext:",
+        "body:",
+        "trailer:X-Checksum=abc",
+        "complete",
+    };
+    EXPECT_EQ(events, expected);
+}
+
+TEST(DeserializeHandlerTest, PipelinedWithContentLength) {
+    std::vector<std::string> events;
+    auto deserialize = make_deserialize_request(recording_handler{ &events }, deserialize_config{});
+
+    const std::string_view input =
+        "POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+        "GET /b HTTP/1.1\r\n\r\n";
+    ASSERT_FALSE(deserialize(detail::buffer_str_to_byte(input)).has_value());
+
+    const std::vector<std::string> expected{
+        "method:POST",
+        "target:/a",
+        "field:Content-Length=3",
+        "headers:chunked=false",
+        "body:abc",
+        "complete",
+        "method:GET",
+        "target:/b",
+        "headers:chunked=false",
+        "complete",
+    };
+    EXPECT_EQ(events, expected);
+}
+
+TEST(DeserializeHandlerTest, SharesLimitsAndFraming) {
+    std::vector<std::string> events;
+    deserialize_config config{ .max_body_size = 2 };
+    auto deserialize = make_deserialize_request(recording_handler{ &events }, std::move(config));
+    const auto maybe_error =
+        deserialize(detail::buffer_str_to_byte("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"));
+    ASSERT_TRUE(maybe_error.has_value());
+    EXPECT_EQ(maybe_error.value(), status_type::CONTENT_TOO_LARGE);
+    EXPECT_EQ(std::ranges::count(events, "complete"), 0);
+}
+
+TEST(DeserializeHandlerTest, HookRejects) {
+    struct rejecting_handler {
+        meta::maybe<status_type> on_field(std::string_view name, std::string_view) {
+            if (detail::equals_lowercase(name, "cookie")) {
+                return status_type::BAD_REQUEST;
+            }
+            return meta::null;
+        }
+    };
+    auto deserialize = make_deserialize_request(rejecting_handler{}, deserialize_config{});
+    const auto maybe_error = deserialize(detail::buffer_str_to_byte("GET / HTTP/1.1\r\nCookie: a=b\r\n\r\n"));
+    ASSERT_TRUE(maybe_error.has_value());
+    EXPECT_EQ(maybe_error.value(), status_type::BAD_REQUEST);
+}
+
+TEST(DeserializerTest, SharedConfigAndHandlerByValue) {
+    const deserialize_config config{ .max_field_count = 1 };
+    std::vector<std::string> first_events;
+    std::vector<std::string> second_events;
+    auto first = make_request_deserializer(recording_handler{ &first_events }, config);
+    auto second = make_request_deserializer(recording_handler{ &second_events }, config);
+
+    const std::string_view input = "GET /a HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        ASSERT_FALSE(first(detail::buffer_str_to_byte(input.substr(i, 1))).has_value());
+    }
+    const std::vector<std::string> expected{
+        "method:GET",
+        "target:/a",
+        "field:Host=example.com",
+        "headers:chunked=false",
+        "complete",
+    };
+    EXPECT_EQ(first_events, expected);
+    EXPECT_EQ(first.handler().events, &first_events);
+
+    // limits come from the same config
+    const auto maybe_error =
+        second(detail::buffer_str_to_byte("GET / HTTP/1.1\r\nHost: example.com\r\nCookie: a=b\r\n\r\n"));
+    ASSERT_TRUE(maybe_error.has_value());
+    EXPECT_EQ(maybe_error.value(), status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+}
+
+TEST(DeserializerTest, SharedConfigWithMessageBuilder) {
+    std::vector<std::string> targets;
+    const deserialize_config config{
+        .message_cb =
+            [&targets](message_type msg) {
+                targets.push_back(std::get<origin_target_type>(std::get<request_line_type>(msg.start_line).target).path);
+            },
+    };
+    // builders reference the callbacks, the config stays usable for every connection
+    auto first = make_request_deserializer(detail::message_builder{ config, /*is_request=*/true }, config);
+    auto second = make_request_deserializer(detail::message_builder{ config, /*is_request=*/true }, config);
+    ASSERT_FALSE(first(detail::buffer_str_to_byte("GET /a HTTP/1.1\r\n\r\n")).has_value());
+    ASSERT_FALSE(second(detail::buffer_str_to_byte("GET /b HTTP/1.1\r\n\r\n")).has_value());
+    EXPECT_EQ(targets, (std::vector<std::string>{ "/a", "/b" }));
+    EXPECT_TRUE(!!config.message_cb);
+    EXPECT_TRUE(!!config.headers_cb);
+}
+
+TEST(DeserializerTest, MinimalPolicy) {
+    const deserialize_config config{};
+    const auto deserialize_one = [&config](std::string_view input) {
+        std::vector<std::string> events;
+        auto deserializer = make_request_deserializer<minimal_deserialize_policy>(recording_handler{ &events }, config);
+        return deserializer(detail::buffer_str_to_byte(input));
+    };
+
+    EXPECT_FALSE(deserialize_one("POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc").has_value());
+    EXPECT_FALSE(deserialize_one("OPTIONS * HTTP/1.1\r\n\r\n").has_value());
+
+    for (const auto& [input, expected] : {
+             std::pair{ "GET / HTTP/1.0\r\n\r\n", status_type::HTTP_VERSION_NOT_SUPPORTED },
+             std::pair{ "GET http://example.com/ HTTP/1.1\r\n\r\n", status_type::BAD_REQUEST },
+             std::pair{ "CONNECT example.com:443 HTTP/1.1\r\n\r\n", status_type::BAD_REQUEST },
+             std::pair{
+                 "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", status_type::NOT_IMPLEMENTED
+             },
+         }) {
+        const auto maybe_error = deserialize_one(input);
+        ASSERT_TRUE(maybe_error.has_value()) << input;
+        EXPECT_EQ(maybe_error.value(), expected) << input;
+    }
+}
+
+TEST(DeserializerTest, PolicyLimitsOverrideConfig) {
+    const deserialize_config config{ .max_field_count = 1 };
+    const std::string_view input = "GET / HTTP/1.1\r\nHost: a\r\nAccept: b\r\n\r\n";
+
+    std::vector<std::string> events;
+    auto deserializer = make_request_deserializer<minimal_deserialize_policy>(recording_handler{ &events }, config);
+    EXPECT_FALSE(deserializer(detail::buffer_str_to_byte(input)).has_value());
+
+    auto default_deserializer = make_request_deserializer(recording_handler{ &events }, config);
+    const auto maybe_error = default_deserializer(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(maybe_error.has_value());
+    EXPECT_EQ(maybe_error.value(), status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+}
+
+struct no_trailers_policy : deserialize_policy {
+    static constexpr bool is_trailers_allowed = false;
+};
+
+TEST(DeserializerTest, TrailersPolicy) {
+    const deserialize_config config{};
+    std::vector<std::string> events;
+    auto deserializer = make_request_deserializer<no_trailers_policy>(recording_handler{ &events }, config);
+
+    const std::string_view chunked = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\na\r\n0\r\n";
+    ASSERT_FALSE(deserializer(detail::buffer_str_to_byte(std::string{ chunked } + "\r\n")).has_value());
+    EXPECT_EQ(std::ranges::count(events, "complete"), 1);
+
+    const auto maybe_error =
+        deserializer(detail::buffer_str_to_byte(std::string{ chunked } + "X-Checksum: abc\r\n\r\n"));
+    ASSERT_TRUE(maybe_error.has_value());
+    EXPECT_EQ(maybe_error.value(), status_type::BAD_REQUEST);
+}
+
+TEST(ParseTest, RequestLeavesPipelinedBytes) {
+    const std::string_view first = "POST /a?x=1 HTTP/1.1\r\nHost: example.com\r\nContent-Length: 3\r\n\r\nabc";
+    const std::string input = std::string{ first } + "GET /b HTTP/1.1\r\n\r\n";
+
+    const auto result = parse_request(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(result.has_value());
+    const auto& [message, offset] = result.value();
+    EXPECT_EQ(offset, first.size());
+    EXPECT_EQ(get_request_line(message).method, method_type::POST);
+    EXPECT_EQ(get_origin_path(get_request_line(message).target), "/a");
+    EXPECT_EQ(message.fields.at("host"), "example.com");
+    EXPECT_EQ(message.body, detail::buffer_str_to_byte("abc"));
+    EXPECT_EQ(message.framing.content_length, 3);
+
+    const auto next = parse_request(detail::buffer_str_to_byte(input).subspan(offset));
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(get_origin_path(get_request_line(next.value().message).target), "/b");
+}
+
+TEST(ParseTest, ResponseChunkedBodyJoined) {
+    const std::string_view input =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;ext\r\nhello\r\n"
+        "6\r\n world\r\n"
+        "0\r\n"
+        "X-Checksum: abc\r\n"
+        "\r\n";
+
+    const auto result = parse_response(detail::buffer_str_to_byte(input));
+    ASSERT_TRUE(result.has_value());
+    const auto& [message, offset] = result.value();
+    EXPECT_EQ(offset, input.size());
+    EXPECT_EQ(std::get<response_line_type>(message.start_line).status, status_type::OK);
+    EXPECT_EQ(message.body, detail::buffer_str_to_byte("hello world"));
+    EXPECT_EQ(message.fields.at("x-checksum"), "abc");
+    EXPECT_TRUE(message.framing.is_chunked);
+}
+
+TEST(ParseTest, IncompleteIsBadRequest) {
+    for (const std::string_view input : {
+             "GET / HTTP/1.1\r\nHost: example.com\r\n",
+             "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nabc",
+             "",
+         }) {
+        const auto result = parse_request(detail::buffer_str_to_byte(input));
+        ASSERT_FALSE(result.has_value()) << input;
+        EXPECT_EQ(result.error(), status_type::BAD_REQUEST);
+    }
+}
+
+TEST(ParseTest, ConfigLimitsAndRetainedFields) {
+    const std::string_view input = "GET / HTTP/1.1\r\nHost: example.com\r\nCookie: a=b\r\n\r\n";
+
+    const deserialize_config retaining{ .retained_fields = field_names_type{ "host" } };
+    const auto retained = parse_request(detail::buffer_str_to_byte(input), retaining);
+    ASSERT_TRUE(retained.has_value());
+    EXPECT_EQ(retained.value().message.fields.size(), 1);
+    EXPECT_TRUE(retained.value().message.fields.contains("host"));
+
+    const deserialize_config limiting{ .max_field_count = 1 };
+    const auto limited = parse_request(detail::buffer_str_to_byte(input), limiting);
+    ASSERT_FALSE(limited.has_value());
+    EXPECT_EQ(limited.error(), status_type::REQUEST_HEADER_FIELDS_TOO_LARGE);
+}
+
 } // namespace sl::http::v1::deserialize
@@ -0,0 +1,146 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/query.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sl::http::v1::deserialize {
+
+std::vector<std::pair<std::string_view, std::string_view>> collect(const query_view& query) {
+    std::vector<std::pair<std::string_view, std::string_view>> result;
+    for (const auto& [key, value] : query) {
+        result.emplace_back(key, value);
+    }
+    return result;
+}
+
+// === Iteration ===
+
+TEST(QueryView, Empty) {
+    const query_view query{ "" };
+    EXPECT_TRUE(query.empty());
+    EXPECT_EQ(query.begin(), query.end());
+}
+
+TEST(QueryView, IterateRawPairs) {
+    const query_view query{ "q=hello+world&page=1&name=John%20Doe" };
+    const auto pairs = collect(query);
+    ASSERT_EQ(pairs.size(), 3);
+    EXPECT_EQ(pairs[0].first, "q");
+    EXPECT_EQ(pairs[0].second, "hello+world");
+    EXPECT_EQ(pairs[1].first, "page");
+    EXPECT_EQ(pairs[1].second, "1");
+    EXPECT_EQ(pairs[2].first, "name");
+    EXPECT_EQ(pairs[2].second, "John%20Doe");
+}
+
+TEST(QueryView, IterateSkipsEmptyPairs) {
+    const query_view query{ "&&flag&key=&&" };
+    const auto pairs = collect(query);
+    ASSERT_EQ(pairs.size(), 2);
+    EXPECT_EQ(pairs[0].first, "flag");
+    EXPECT_EQ(pairs[0].second, "");
+    EXPECT_EQ(pairs[1].first, "key");
+    EXPECT_EQ(pairs[1].second, "");
+}
+
+TEST(QueryView, IterateValueWithEquals) {
+    const query_view query{ "sig=abc==" };
+    const auto pairs = collect(query);
+    ASSERT_EQ(pairs.size(), 1);
+    EXPECT_EQ(pairs[0].first, "sig");
+    EXPECT_EQ(pairs[0].second, "abc==");
+}
+
+// === Decoding ===
+
+TEST(QueryView, FindDecodesIntoBuffer) {
+    const query_view query{ "q=hello+world&page=1&sig=a%21" };
+    std::array<char, 16> buffer{};
+    const auto q = query.find("q", buffer);
+    ASSERT_TRUE(q.has_value());
+    EXPECT_EQ(q.value(), "hello world");
+    EXPECT_EQ(q.value().data(), buffer.data());
+    const auto page = query.find("page", buffer);
+    ASSERT_TRUE(page.has_value());
+    EXPECT_EQ(page.value(), "1");
+    EXPECT_EQ(page.value().data(), query.raw().data() + query.raw().find('1'));
+}
+
+TEST(QueryView, FindBufferTooShort) {
+    const query_view query{ "sig=a%21" };
+    std::array<char, 3> buffer{};
+    EXPECT_FALSE(query.find("sig", buffer).has_value());
+    std::array<char, 4> exact{};
+    EXPECT_EQ(query.find("sig", exact), std::string_view{ "a!" });
+}
+
+// === Lookup ===
+
+TEST(QueryView, FindEncodedKey) {
+    const query_view query{ "first%20name=John" };
+    const auto result = query.find_raw("first name");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "John");
+}
+
+TEST(QueryView, FindMissing) {
+    const query_view query{ "a=1" };
+    EXPECT_FALSE(query.find_raw("b").has_value());
+    EXPECT_FALSE(query.contains("b"));
+}
+
+TEST(QueryView, FindFirstOfDuplicates) {
+    const query_view query{ "key=1&key=2" };
+    const auto result = query.find_raw("key");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "1");
+}
+
+TEST(QueryView, FindMalformedValue) {
+    const query_view query{ "a=%zz" };
+    std::array<char, 8> buffer{};
+    EXPECT_TRUE(query.contains("a"));
+    EXPECT_FALSE(query.find("a", buffer).has_value());
+}
+
+// Lookups past the threshold go through the lazily built index and must agree with the scan
+TEST(QueryView, FindAfterIndexThreshold) {
+    std::string query_str;
+    for (int i = 0; i < 32; ++i) {
+        query_str += "utm_" + std::to_string(i) + "=v" + std::to_string(i) + "&";
+    }
+    query_str += "key=1&key=2&bad%2=x";
+    const query_view query{ query_str };
+
+    for (std::size_t round = 0; round < query_view::index_threshold * 2; ++round) {
+        const auto utm = query.find_raw("utm_17");
+        ASSERT_TRUE(utm.has_value());
+        EXPECT_EQ(utm.value(), "v17");
+
+        const auto key = query.find_raw("key");
+        ASSERT_TRUE(key.has_value());
+        EXPECT_EQ(key.value(), "1");
+
+        EXPECT_FALSE(query.contains("missing"));
+    }
+}
+
+TEST(QueryView, CopyKeepsLookups) {
+    const query_view query{ "a=1&b=2" };
+    for (std::size_t i = 0; i <= query_view::index_threshold; ++i) {
+        std::ignore = query.find_raw("a");
+    }
+    const query_view copy = query;
+    const auto result = copy.find_raw("b");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "2");
+}
+
+} // namespace sl::http::v1::deserialize
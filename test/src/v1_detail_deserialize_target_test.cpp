@@ -91,6 +91,76 @@ TEST(DeserializeTarget, OriginFormDuplicateKeys) {
     EXPECT_EQ(origin->query[2].second, "3");
 }
 
+TEST(DeserializeTarget, OriginFormLongPercentDecoded) {
+    std::string encoded = "/";
+    std::string decoded = "/";
+    for (int i = 0; i < 64; ++i) {
+        encoded += "segment-" + std::to_string(i) + "%2F%e2%9C%93/";
+        decoded += "segment-" + std::to_string(i) + "/\xE2\x9C\x93/";
+    }
+    encoded += "?token=" + std::string(100, 'x') + "%3D%3D+tail";
+
+    auto result = deserialize_target(encoded);
+    ASSERT_TRUE(result.has_value());
+    auto* origin = std::get_if<origin_target_type>(&result.value());
+    ASSERT_NE(origin, nullptr);
+    EXPECT_EQ(origin->path, decoded);
+    ASSERT_EQ(origin->query.size(), 1);
+    EXPECT_EQ(origin->query[0].second, std::string(100, 'x') + "== tail");
+}
+
+TEST(DeserializeTarget, PathPlusIsLiteral) {
+    auto result = deserialize_target("/a+b");
+    ASSERT_TRUE(result.has_value());
+    auto* origin = std::get_if<origin_target_type>(&result.value());
+    ASSERT_NE(origin, nullptr);
+    EXPECT_EQ(origin->path, "/a+b");
+}
+
+// === In-place ===
+
+TEST(DeserializeTarget, PercentDecodeInPlace) {
+    std::string buffer = "/a%20b/%E2%9C%93/c";
+    const auto result = detail::percent_decode::str_in_place(buffer);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "/a b/\xE2\x9C\x93/c");
+    EXPECT_EQ(result.value().data(), buffer.data());
+}
+
+TEST(DeserializeTarget, PercentDecodeQueryInPlace) {
+    std::string buffer = "hello+world%21";
+    const auto result = detail::percent_decode::query_in_place(buffer);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "hello world!");
+}
+
+TEST(DeserializeTarget, PercentDecodeInPlaceInvalid) {
+    std::string buffer = "/ok%2";
+    EXPECT_FALSE(detail::percent_decode::str_in_place(buffer).has_value());
+}
+
+TEST(DeserializeTarget, OriginFormInPlace) {
+    std::string buffer = "/files/my%20doc.txt?v=1&name=a+b";
+    const auto result = detail::deserialize_origin_form_in_place(buffer);
+    ASSERT_TRUE(result.has_value());
+    const auto& origin = result.value();
+    EXPECT_EQ(origin.path, "/files/my doc.txt");
+    EXPECT_GE(origin.path.data(), buffer.data());
+    EXPECT_LE(origin.path.data() + origin.path.size(), buffer.data() + buffer.size());
+    EXPECT_EQ(origin.query.raw(), "v=1&name=a+b");
+    // decoded over its own raw bytes, the query is part of the same buffer
+    const std::string_view raw_name = origin.query.find_raw("name").value();
+    const auto name = origin.query.find("name", std::span{ buffer }.subspan(static_cast<std::size_t>(raw_name.data() - buffer.data())));
+    ASSERT_TRUE(name.has_value());
+    EXPECT_EQ(name.value(), "a b");
+    EXPECT_EQ(name.value().data(), raw_name.data());
+}
+
+TEST(DeserializeTarget, OriginFormInPlaceNotOrigin) {
+    std::string buffer = "http://example.com/";
+    EXPECT_FALSE(detail::deserialize_origin_form_in_place(buffer).has_value());
+}
+
 // === Absolute Form ===
 
 TEST(DeserializeTarget, AbsoluteFormHttp) {
@@ -98,8 +168,9 @@ TEST(DeserializeTarget, AbsoluteFormHttp) {
     ASSERT_TRUE(result.has_value());
     auto* absolute = std::get_if<absolute_target_type>(&result.value());
     ASSERT_NE(absolute, nullptr);
-    EXPECT_EQ(absolute->scheme, "http");
-    EXPECT_EQ(absolute->authority, "example.com");
+    EXPECT_EQ(absolute->scheme, scheme_type::HTTP);
+    EXPECT_EQ(absolute->host, "example.com");
+    EXPECT_EQ(absolute->port, 80);
     EXPECT_EQ(absolute->path, "/path");
     ASSERT_EQ(absolute->query.size(), 1);
     EXPECT_EQ(absolute->query[0].first, "q");
@@ -110,8 +181,9 @@ TEST(DeserializeTarget, AbsoluteFormHttps) {
     ASSERT_TRUE(result.has_value());
     auto* absolute = std::get_if<absolute_target_type>(&result.value());
     ASSERT_NE(absolute, nullptr);
-    EXPECT_EQ(absolute->scheme, "https");
-    EXPECT_EQ(absolute->authority, "secure.example.com:8443");
+    EXPECT_EQ(absolute->scheme, scheme_type::HTTPS);
+    EXPECT_EQ(absolute->host, "secure.example.com");
+    EXPECT_EQ(absolute->port, 8443);
     EXPECT_EQ(absolute->path, "/api");
 }
 
@@ -128,10 +200,63 @@ TEST(DeserializeTarget, AbsoluteFormNoPath) {
     ASSERT_TRUE(result.has_value());
     auto* absolute = std::get_if<absolute_target_type>(&result.value());
     ASSERT_NE(absolute, nullptr);
-    EXPECT_EQ(absolute->authority, "example.com");
+    EXPECT_EQ(absolute->host, "example.com");
     EXPECT_EQ(absolute->path, "/");
 }
 
+TEST(DeserializeTarget, AbsoluteFormDefaultHttpsPort) {
+    auto result = deserialize_target("https://example.com");
+    ASSERT_TRUE(result.has_value());
+    auto* absolute = std::get_if<absolute_target_type>(&result.value());
+    ASSERT_NE(absolute, nullptr);
+    EXPECT_EQ(absolute->port, 443);
+    EXPECT_TRUE(absolute->userinfo.empty());
+}
+
+TEST(DeserializeTarget, AbsoluteFormEmptyPort) {
+    auto result = deserialize_target("http://example.com:/");
+    ASSERT_TRUE(result.has_value());
+    auto* absolute = std::get_if<absolute_target_type>(&result.value());
+    ASSERT_NE(absolute, nullptr);
+    EXPECT_EQ(absolute->host, "example.com");
+    EXPECT_EQ(absolute->port, 80);
+}
+
+TEST(DeserializeTarget, AbsoluteFormUserinfo) {
+    auto result = deserialize_target("http://user:p@ss@example.com:8080/x");
+    ASSERT_TRUE(result.has_value());
+    auto* absolute = std::get_if<absolute_target_type>(&result.value());
+    ASSERT_NE(absolute, nullptr);
+    EXPECT_EQ(absolute->userinfo, "user:p@ss");
+    EXPECT_EQ(absolute->host, "example.com");
+    EXPECT_EQ(absolute->port, 8080);
+    EXPECT_EQ(absolute->path, "/x");
+}
+
+TEST(DeserializeTarget, AbsoluteFormIpv6) {
+    auto result = deserialize_target("http://[2001:db8::1]:8080/x");
+    ASSERT_TRUE(result.has_value());
+    auto* absolute = std::get_if<absolute_target_type>(&result.value());
+    ASSERT_NE(absolute, nullptr);
+    EXPECT_EQ(absolute->host, "2001:db8::1");
+    EXPECT_EQ(absolute->port, 8080);
+}
+
+TEST(DeserializeTarget, AbsoluteFormInvalidAuthority) {
+    for (const std::string_view target : {
+             "http:///path",
+             "http://user@/path",
+             "http://example.com:99999/",
+             "http://example.com:8a/",
+             "http://[::1/",
+             "http://[]/",
+             "http://[::1]8080/",
+             "http://[::g]/",
+         }) {
+        EXPECT_FALSE(deserialize_target(target).has_value()) << target;
+    }
+}
+
 // === Authority Form ===
 
 TEST(DeserializeTarget, AuthorityForm) {
@@ -182,6 +307,11 @@ TEST(DeserializeTarget, InvalidPercentEncodingTrailing) {
     EXPECT_FALSE(result.has_value());
 }
 
+TEST(DeserializeTarget, InvalidPercentEncodingAfterLongCleanRun) {
+    auto result = deserialize_target("/" + std::string(100, 'a') + "%4");
+    EXPECT_FALSE(result.has_value());
+}
+
 TEST(DeserializeTarget, InvalidPortOverflow) {
     auto result = deserialize_target("host:99999");
     EXPECT_FALSE(result.has_value());
@@ -0,0 +1,62 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/detail/hash.hpp"
+#include "sl/http/v1/detail/strings.hpp"
+#include "sl/http/v1/types/fields.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_set>
+
+namespace sl::http::v1::detail {
+
+TEST(Hash, StableWithinProcess) {
+    EXPECT_EQ(seeded_hash("content-length"), seeded_hash(std::string{ "content-length" }));
+    EXPECT_EQ(seeded_hash(""), seeded_hash(std::string_view{}));
+}
+
+TEST(Hash, LowercaseMatchesLowercased) {
+    for (const std::string_view str : { "", "Host", "CONTENT-LENGTH", "x-Request-Id-With-A-Long-Tail", "1234567" }) {
+        EXPECT_EQ(seeded_hash_lowercase(str), seeded_hash(to_lowercase(str))) << str;
+    }
+}
+
+TEST(Hash, Spreads) {
+    std::unordered_set<std::size_t> hashes;
+    for (std::size_t i = 0; i < 10000; ++i) {
+        hashes.insert(seeded_hash("x-" + std::to_string(i)));
+    }
+    EXPECT_EQ(hashes.size(), 10000);
+}
+
+TEST(Hash, LengthIsPartOfHash) {
+    EXPECT_NE(seeded_hash(std::string_view{ "a\0", 2 }), seeded_hash("a"));
+    EXPECT_NE(seeded_hash(std::string(8, '\0')), seeded_hash(std::string(16, '\0')));
+}
+
+TEST(Hash, FieldNamesCaseInsensitive) {
+    const field_names_type names{ "host", "X-Request-Id" };
+    EXPECT_TRUE(names.contains("HOST"));
+    EXPECT_TRUE(names.contains("x-request-id"));
+    EXPECT_FALSE(names.contains("x-request"));
+}
+
+TEST(Hash, FieldKey) {
+    const fields_type fields{ { "content-type", "text/plain" }, { "host", "example.com" } };
+    const field_key content_type{ "Content-Type" };
+    EXPECT_EQ(content_type.name(), "content-type");
+    EXPECT_EQ(content_type.hash(), fields.hash_function()("content-type"));
+
+    const auto it = find_field(fields, content_type);
+    ASSERT_NE(it, fields.end());
+    EXPECT_EQ(it->second, "text/plain");
+    EXPECT_TRUE(contains_field(fields, field_key_v<"HOST">));
+    EXPECT_FALSE(contains_field(fields, field_key_v<"content-length">));
+    EXPECT_EQ(&field_key_v<"HOST">, &field_key_v<"HOST">);
+    EXPECT_EQ(field_key_v<"HOST">.name(), "host");
+}
+
+} // namespace sl::http::v1::detail
@@ -0,0 +1,142 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/message.hpp"
+#include "sl/http/v1/detail/intern.hpp"
+#include "sl/http/v1/detail/strings.hpp"
+#include "sl/http/v1/types/fields.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sl::http::v1::detail {
+
+TEST(Intern, CommonNamesInterned) {
+    const auto* host = intern_field_name("host");
+    ASSERT_NE(host, nullptr);
+    EXPECT_EQ(host->name, "host");
+    EXPECT_EQ(host->hash, seeded_hash("host"));
+    EXPECT_EQ(intern_field_name(std::string{ "host" }), host);
+    EXPECT_NE(intern_field_name("user-agent"), host);
+}
+
+TEST(Intern, ConcurrentInsertsYieldOneEntry) {
+    constexpr std::size_t thread_count = 4;
+    std::vector<std::vector<const interned_field_name*>> results(thread_count);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&results, t] {
+            for (std::size_t i = 0; i < 100; ++i) {
+                results[t].push_back(intern_field_name("x-concurrent-" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 1; t < thread_count; ++t) {
+        EXPECT_EQ(results[t], results[0]);
+    }
+}
+
+TEST(Intern, FieldNameIsPointerSized) {
+    static_assert(sizeof(field_name) == sizeof(void*));
+
+    const field_name a{ "content-type" };
+    const field_name b{ std::string{ "content-type" } };
+    EXPECT_TRUE(a.is_interned());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, "content-type");
+    EXPECT_NE(a, field_name{ "Content-Type" });
+    EXPECT_EQ(a.hash(), seeded_hash("content-type"));
+
+    fields_type fields{ { "content-type", "text/plain" } };
+    EXPECT_EQ(fields.at("content-type"), "text/plain");
+    EXPECT_EQ(fields.at(b), "text/plain");
+}
+
+TEST(Intern, PeerNamesNotInterned) {
+    const std::size_t count = interned_field_name_count();
+
+    for (std::size_t round = 0; round < 64; ++round) { // a new set of names every time
+        std::string request = "GET / HTTP/1.1\r\nHost: a\r\n";
+        for (std::size_t i = 0; i < 64; ++i) {
+            request += "X-Flood-" + std::to_string(round) + "-" + std::to_string(i) + ": junk\r\n";
+        }
+        request += "\r\n";
+        const auto result = parse_request(buffer_str_to_byte(request));
+        ASSERT_TRUE(result.has_value());
+        const auto& fields = result.value().message.fields;
+        EXPECT_EQ(fields.size(), 65);
+        EXPECT_FALSE(fields.find("x-flood-" + std::to_string(round) + "-0")->first.is_interned());
+        EXPECT_TRUE(fields.find("host")->first.is_interned());
+    }
+    for (std::size_t i = 0; i < max_interned_field_name_count * 2; ++i) {
+        EXPECT_FALSE(field_name{ "x-peer-" + std::to_string(i) }.is_interned());
+    }
+
+    EXPECT_EQ(interned_field_name_count(), count);
+    EXPECT_EQ(find_interned_field_name("x-flood-0-0"), nullptr);
+}
+
+TEST(Intern, RetainedNamesInterned) {
+    const deserialize_config config{ .retained_fields = field_names_type{ "X-Tenant" } };
+    const auto result = parse_request(buffer_str_to_byte("GET / HTTP/1.1\r\nX-Tenant: t\r\nX-Junk: j\r\n\r\n"), config);
+    ASSERT_TRUE(result.has_value());
+    const auto& fields = result.value().message.fields;
+    ASSERT_TRUE(fields.contains("x-tenant"));
+    EXPECT_FALSE(fields.contains("x-junk"));
+    EXPECT_TRUE(fields.find("x-tenant")->first.is_interned());
+    EXPECT_NE(find_interned_field_name("x-tenant"), nullptr);
+
+    const field_key key{ "X-App-Key" };
+    EXPECT_TRUE(key.name().is_interned());
+}
+
+TEST(Intern, OwnedNames) {
+    for (const std::string_view name : { "x-a", "x-seven", "x-eight!", "x-a-rather-long-peer-field-name" }) {
+        const field_name owned{ name };
+        EXPECT_FALSE(owned.is_interned()) << name;
+        EXPECT_EQ(owned.view(), name);
+        EXPECT_EQ(owned, field_name{ std::string{ name } });
+        EXPECT_NE(owned, field_name{ "x-other" });
+        EXPECT_EQ(owned.hash(), seeded_hash(name));
+
+        field_name copy = owned;
+        EXPECT_EQ(copy, owned);
+        field_name moved = std::move(copy);
+        EXPECT_EQ(moved, owned);
+        copy = moved;
+        EXPECT_EQ(copy.view(), name);
+
+        fields_type fields;
+        fields.try_emplace(owned, "value");
+        EXPECT_EQ(fields.at(name), "value");
+    }
+}
+
+// fills the process-wide table, so in a child process of its own
+TEST(InternDeathTest, BoundedGrowth) {
+    EXPECT_EXIT(
+        {
+            std::size_t i = 0;
+            while (i <= max_interned_field_name_count && intern_field_name("x-fill-" + std::to_string(i)) != nullptr) {
+                ++i;
+            }
+            const bool is_bounded = i <= max_interned_field_name_count
+                                    && intern_field_name("x-one-too-many") == nullptr
+                                    && intern_field_name("host") != nullptr
+                                    && !field_name{ "x-one-too-many" }.is_interned();
+            std::exit(is_bounded ? 0 : 1);
+        },
+        ::testing::ExitedWithCode(0),
+        ""
+    );
+}
+
+} // namespace sl::http::v1::detail
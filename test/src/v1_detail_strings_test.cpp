@@ -6,6 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <vector>
+
 namespace sl::http::v1::detail {
 
 enum class test_enum {
@@ -222,6 +225,24 @@ TEST(v1DetailStrings, tryFindSplit) {
     }
 }
 
+TEST(v1DetailStrings, findFirstOf) {
+    EXPECT_EQ(find_first_of("", '%', '+'), std::string_view::npos);
+    EXPECT_EQ(find_first_of("abc", '%', '+'), std::string_view::npos);
+    EXPECT_EQ(find_first_of("a+c", '%', '+'), 1);
+    EXPECT_EQ(find_first_of("%", '%', '+'), 0);
+    EXPECT_EQ(find_first_of("abcdefgh+", '%', '+'), 8);
+    EXPECT_EQ(find_first_of("abcdefghijklmnopqrstuvw%xyz+", '%', '+'), 23);
+    EXPECT_EQ(find_first_of("abcdefghijklmnopqrstuvwxyzabcdef", '%', '+'), std::string_view::npos);
+
+    // every position across word boundaries, including bytes with the high bit set
+    std::string str(40, '\xC5');
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        str[i] = '+';
+        EXPECT_EQ(find_first_of(str, '%', '+'), i);
+        str[i] = '\xC5';
+    }
+}
+
 TEST(v1DetailStrings, toLowercase) {
     EXPECT_EQ(to_lowercase(""), "");
     EXPECT_EQ(to_lowercase("abc"), "abc");
@@ -248,4 +269,75 @@ TEST(v1DetailStrings, isLowercase) {
     EXPECT_FALSE(is_lowercase("abcD"));
 }
 
+TEST(v1DetailStrings, equalsLowercase) {
+    EXPECT_TRUE(equals_lowercase("", ""));
+    EXPECT_TRUE(equals_lowercase("chunked", "chunked"));
+    EXPECT_TRUE(equals_lowercase("ChUnKeD", "chunked"));
+    EXPECT_TRUE(equals_lowercase("100-Continue", "100-continue"));
+    EXPECT_FALSE(equals_lowercase("chunke", "chunked"));
+    EXPECT_FALSE(equals_lowercase("chunkedx", "chunked"));
+}
+
+TEST(v1DetailStrings, forEachListElement) {
+    const auto collect = [](std::string_view list) {
+        std::vector<std::string_view> elements;
+        for_each_list_element(list, [&](std::string_view element) { elements.push_back(element); });
+        return elements;
+    };
+    EXPECT_EQ(collect(""), std::vector<std::string_view>{});
+    EXPECT_EQ(collect("a"), std::vector<std::string_view>{ "a" });
+    EXPECT_EQ(collect(" a ,b,\tc "), (std::vector<std::string_view>{ "a", "b", "c" }));
+    EXPECT_EQ(collect(", ,a,,"), std::vector<std::string_view>{ "a" });
+}
+
+TEST(v1DetailStrings, scanFieldLine) {
+    std::array<char, 8> buffer{};
+    const auto scan = [&buffer](std::string_view str, std::size_t max_size = 64) {
+        return scan_field_line(str, max_size, buffer);
+    };
+
+    const auto host = scan("Host: \texample.com \r\nrest");
+    ASSERT_TRUE(host.has_value());
+    EXPECT_EQ(host->name, "Host");
+    EXPECT_EQ(host->lowercase_name, "host");
+    EXPECT_EQ(host->value, "example.com");
+    EXPECT_EQ(host->offset, 21);
+
+    // too long for the buffer, folded by the caller
+    const auto long_name = scan("Content-Type:text/plain\r\n");
+    ASSERT_TRUE(long_name.has_value());
+    EXPECT_EQ(long_name->name, "Content-Type");
+    EXPECT_TRUE(long_name->lowercase_name.empty());
+    EXPECT_EQ(long_name->value, "text/plain");
+
+    const auto empty_value = scan("X-Empty:  \r\n");
+    ASSERT_TRUE(empty_value.has_value());
+    EXPECT_EQ(empty_value->value, "");
+
+    const auto bare_cr = scan("X:a\rb\r\n");
+    ASSERT_TRUE(bare_cr.has_value());
+    EXPECT_EQ(bare_cr->value, "a\rb");
+
+    const auto last = scan("\r\nbody");
+    ASSERT_TRUE(last.has_value());
+    EXPECT_TRUE(last->name.empty());
+    EXPECT_EQ(last->offset, 2);
+
+    for (const std::string_view incomplete : { "", "\r", "Host", "Host: exa", "Host: example.com\r" }) {
+        const auto result = scan(incomplete);
+        ASSERT_FALSE(result.has_value()) << incomplete;
+        EXPECT_EQ(result.error(), field_line_err::NOT_FOUND) << incomplete;
+    }
+    for (const std::string_view malformed : { "Host : a\r\n", " Host: a\r\n", ": a\r\n", "H\"st: a\r\n", "\rX" }) {
+        const auto result = scan(malformed);
+        ASSERT_FALSE(result.has_value()) << malformed;
+        EXPECT_EQ(result.error(), field_line_err::MALFORMED) << malformed;
+    }
+
+    EXPECT_TRUE(scan("Host: abc\r\n", 9).has_value());
+    const auto exceeded = scan("Host: abcd\r\n", 9);
+    ASSERT_FALSE(exceeded.has_value());
+    EXPECT_EQ(exceeded.error(), field_line_err::MAX_SIZE_EXCEEDED);
+}
+
 } // namespace sl::http::v1::deserialize::detail
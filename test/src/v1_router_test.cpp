@@ -0,0 +1,234 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/router.hpp"
+#include "sl/http/v1/deserialize/target.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace sl::http::v1 {
+
+// === Static ===
+
+TEST(Router, StaticRoutes) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/", 0));
+    ASSERT_FALSE(r.add(method_type::GET, "/api/v1/users", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/api/v1/posts", 2));
+    ASSERT_FALSE(r.add(method_type::GET, "/api", 3));
+
+    const auto expect_value = [&r](std::string_view path, int value) {
+        const auto result = r.match(method_type::GET, path);
+        ASSERT_TRUE(result.has_value()) << path;
+        EXPECT_EQ(result.value().value, value) << path;
+        EXPECT_TRUE(result.value().captures.empty()) << path;
+    };
+    expect_value("/", 0);
+    expect_value("/api/v1/users", 1);
+    expect_value("/api/v1/posts", 2);
+    expect_value("/api", 3);
+}
+
+TEST(Router, StaticNotFound) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/api/v1/users", 1));
+
+    for (const std::string_view path : { "", "api", "/api", "/api/v1", "/api/v1/user", "/api/v1/users/", "/api/v1/usersx" }) {
+        const auto result = r.match(method_type::GET, path);
+        ASSERT_FALSE(result.has_value()) << path;
+        EXPECT_EQ(result.error(), status_type::NOT_FOUND) << path;
+    }
+}
+
+TEST(Router, TrailingSlashIsDistinct) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/dir", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/dir/", 2));
+    EXPECT_EQ(r.match(method_type::GET, "/dir").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/dir/").value().value, 2);
+}
+
+// === Captures ===
+
+TEST(Router, ParamCapture) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/users/:id/posts/:post", 1));
+
+    const auto result = r.match(method_type::GET, "/users/42/posts/abc");
+    ASSERT_TRUE(result.has_value());
+    const auto& captures = result.value().captures;
+    ASSERT_EQ(captures.size(), 2);
+    EXPECT_EQ(captures[0].name, "id");
+    EXPECT_EQ(captures[0].value, "42");
+    EXPECT_EQ(captures.find("post").value_or(""), "abc");
+    EXPECT_FALSE(captures.find("missing").has_value());
+}
+
+TEST(Router, ParamDoesNotMatchEmptySegment) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/users/:id", 1));
+    EXPECT_FALSE(r.match(method_type::GET, "/users/").has_value());
+    EXPECT_FALSE(r.match(method_type::GET, "/users/1/2").has_value());
+}
+
+TEST(Router, WildcardCapture) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/static/*file", 1));
+
+    const auto result = r.match(method_type::GET, "/static/css/main.css");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().captures.find("file").value_or(""), "css/main.css");
+}
+
+TEST(Router, Priority) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/users/*rest", 3));
+    ASSERT_FALSE(r.add(method_type::GET, "/users/:id", 2));
+    ASSERT_FALSE(r.add(method_type::GET, "/users/me", 1));
+
+    EXPECT_EQ(r.match(method_type::GET, "/users/me").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/users/42").value().value, 2);
+    EXPECT_EQ(r.match(method_type::GET, "/users/42/avatar").value().value, 3);
+}
+
+TEST(Router, Backtracking) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/a/b/c", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/a/:x/d", 2));
+
+    // static "b" is tried first and fails on "d", then the param branch matches
+    const auto result = r.match(method_type::GET, "/a/b/d");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().value, 2);
+    ASSERT_EQ(result.value().captures.size(), 1);
+    EXPECT_EQ(result.value().captures[0].value, "b");
+}
+
+TEST(Router, SplitCompressedNode) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/a/b/c/d", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/a/b/x", 2));
+    ASSERT_FALSE(r.add(method_type::GET, "/a/bb", 3));
+    ASSERT_FALSE(r.add(method_type::GET, "/a/b", 4));
+
+    EXPECT_EQ(r.match(method_type::GET, "/a/b/c/d").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/a/b/x").value().value, 2);
+    EXPECT_EQ(r.match(method_type::GET, "/a/bb").value().value, 3);
+    EXPECT_EQ(r.match(method_type::GET, "/a/b").value().value, 4);
+    EXPECT_FALSE(r.match(method_type::GET, "/a").has_value());
+    EXPECT_FALSE(r.match(method_type::GET, "/a/b/c").has_value());
+}
+
+// === Encoding ===
+
+TEST(Router, EscapedSlashStaysInSegment) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/:x/:y", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/files/a/b", 2));
+    ASSERT_FALSE(r.add(method_type::GET, "/:x", 3));
+
+    const auto result = r.match(method_type::GET, "/a%2Fb");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().value, 3);
+    EXPECT_EQ(result.value().captures.find("x").value_or(""), "a%2Fb");
+
+    EXPECT_EQ(r.match(method_type::GET, "/a/b").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/files/a/b").value().value, 2);
+    EXPECT_EQ(r.match(method_type::GET, "/files/a%2Fb").value().value, 1);
+}
+
+TEST(Router, StaticSegmentsDecoded) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/caf\xc3\xa9/menu", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/a b/:id", 2));
+
+    EXPECT_EQ(r.match(method_type::GET, "/caf%C3%A9/menu").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/caf%c3%a9/menu").value().value, 1);
+    EXPECT_EQ(r.match(method_type::GET, "/%61%20b/1").value().value, 2);
+    EXPECT_FALSE(r.match(method_type::GET, "/caf%C3/menu").has_value());
+    EXPECT_FALSE(r.match(method_type::GET, "/a%2").has_value());
+}
+
+TEST(Router, MatchDeserializedTarget) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/:x/:y", 1));
+    ASSERT_FALSE(r.add(method_type::GET, "/:x", 2));
+    ASSERT_FALSE(r.add(method_type::GET, "/100%", 3));
+
+    const auto match_target = [&r](std::string_view target) {
+        return r.match(method_type::GET, deserialize_target(target).value()).value().value;
+    };
+    EXPECT_EQ(match_target("/a%2Fb"), 2);
+    EXPECT_EQ(match_target("/a/b"), 1);
+    EXPECT_EQ(match_target("/100%25"), 3);
+    EXPECT_EQ(match_target("http://example.com/a%2Fb?q=1"), 2);
+}
+
+// === Methods ===
+
+TEST(Router, MethodNotAllowed) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/items/:id", 1));
+    ASSERT_FALSE(r.add(method_type::DELETE, "/items/:id", 2));
+
+    EXPECT_EQ(r.match(method_type::GET, "/items/1").value().value, 1);
+    EXPECT_EQ(r.match(method_type::DELETE, "/items/1").value().value, 2);
+
+    const auto result = r.match(method_type::POST, "/items/1");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), status_type::METHOD_NOT_ALLOWED);
+}
+
+TEST(Router, MatchRequestLine) {
+    router<int> r;
+    ASSERT_FALSE(r.add(method_type::GET, "/search", 1));
+
+    const request_line_type request_line{
+        .target = origin_target_type{ .path = "/search", .query = { { "q", "x" } } },
+        .method = method_type::GET,
+        .version = version_type::HTTPv1_1,
+    };
+    EXPECT_EQ(r.match(request_line).value().value, 1);
+    EXPECT_EQ(r.match(method_type::OPTIONS, asterisk_target_type{}).error(), status_type::NOT_FOUND);
+}
+
+// === Errors ===
+
+TEST(Router, InvalidPatterns) {
+    router<int> r;
+    EXPECT_EQ(r.add(method_type::GET, "no-slash", 0), std::errc::invalid_argument);
+    EXPECT_EQ(r.add(method_type::GET, "/:", 0), std::errc::invalid_argument);
+    EXPECT_EQ(r.add(method_type::GET, "/*rest/more", 0), std::errc::invalid_argument);
+    EXPECT_EQ(r.add(method_type::GET, "/:a/:b/:c/:d/:e/:f/:g/:h/:i", 0), std::errc::invalid_argument);
+
+    ASSERT_FALSE(r.add(method_type::GET, "/users/:id", 1));
+    EXPECT_EQ(r.add(method_type::GET, "/users/:name/posts", 2), std::errc::invalid_argument);
+    EXPECT_EQ(r.add(method_type::GET, "/users/:id", 3), std::errc::file_exists);
+    EXPECT_FALSE(r.add(method_type::PUT, "/users/:id", 4));
+}
+
+// Routes with shared prefixes and many siblings must all stay reachable
+TEST(Router, ManyRoutes) {
+    router<std::size_t> r;
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < 64; ++i) {
+        paths.push_back("/api/resource" + std::to_string(i));
+        paths.push_back("/api/resource" + std::to_string(i) + "/items");
+        paths.push_back("/api/resource" + std::to_string(i) + "/items/:id");
+    }
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        ASSERT_FALSE(r.add(method_type::GET, paths[i], i)) << paths[i];
+    }
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        const auto path = paths[i].ends_with(":id") ? paths[i].substr(0, paths[i].size() - 3) + "7" : paths[i];
+        const auto result = r.match(method_type::GET, path);
+        ASSERT_TRUE(result.has_value()) << path;
+        EXPECT_EQ(result.value().value, i) << path;
+    }
+}
+
+} // namespace sl::http::v1
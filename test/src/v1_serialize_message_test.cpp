@@ -2,23 +2,30 @@
 // Created by usatiynyan.
 //
 
+#include "sl/http/v1/deserialize/message.hpp"
 #include "sl/http/v1/detail/strings.hpp"
 #include "sl/http/v1/serialize/message.hpp"
 
 #include <gtest/gtest.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace sl::http::v1::serialize {
 
 class SerializeMessageTest : public ::testing::Test {
 protected:
-    meta::maybe<std::string> serialize(const message_type& msg) {
+    meta::maybe<std::string> serialize(const message_type& msg, serialize_config config = { .buffer_size = 1024 }) {
         std::vector<std::byte> buffer;
-        serialize_config config{ .buffer_size = 1024 };
         auto serializer = make_serialize(msg, config);
 
         std::size_t written = 0;
         while (true) {
-            auto span = serializer(written);
+            auto result = serializer(written);
+            if (!result.has_value()) {
+                return meta::null;
+            }
+            const auto span = result.value();
             if (span.empty()) {
                 break;
             }
@@ -79,8 +86,9 @@ TEST_F(SerializeMessageTest, RequestAbsoluteForm) {
             request_line_type{
                 .target =
                     absolute_target_type{
-                        .scheme = "http",
-                        .authority = "example.com",
+                        .scheme = scheme_type::HTTP,
+                        .host = "example.com",
+                        .port = 80,
                         .path = "/path",
                         .query = {},
                     },
@@ -263,4 +271,159 @@ TEST_F(SerializeMessageTest, ResponseHTTP10) {
     EXPECT_EQ(result.value(), "HTTP/1.0 200 OK\r\n\r\n");
 }
 
+TEST_F(SerializeMessageTest, Continue) {
+    EXPECT_EQ(detail::buffer_byte_to_str(serialize_continue()), "HTTP/1.1 100 Continue\r\n\r\n");
+}
+
+// === Connection ===
+
+TEST_F(SerializeMessageTest, ConnectionVersionDefaultNotWritten) {
+    for (const auto& [version, connection] : {
+             std::pair{ version_type::HTTPv1_1, connection_type::KEEP_ALIVE },
+             std::pair{ version_type::HTTPv1_0, connection_type::CLOSE },
+         }) {
+        message_type msg{
+            .fields = {},
+            .body = {},
+            .start_line = response_line_type{ .reason = "OK", .status = status_type::OK, .version = version },
+            .framing = { .connection = connection },
+        };
+        auto result = serialize(msg, serialize_config{ .peer_version = version });
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result.value().find("connection"), std::string::npos);
+    }
+}
+
+// an HTTP/1.1 response to an HTTP/1.0 client that asked for keep-alive
+TEST_F(SerializeMessageTest, ConnectionPeerDefaultDiffers) {
+    const message_type msg{
+        .start_line =
+            response_line_type{ .reason = "OK", .status = status_type::OK, .version = version_type::HTTPv1_1 },
+        .framing = { .connection = connection_type::KEEP_ALIVE },
+    };
+    const std::string_view expected = "HTTP/1.1 200 OK\r\nconnection:keep-alive\r\n\r\n";
+    EXPECT_EQ(serialize(msg, serialize_config{ .peer_version = version_type::HTTPv1_0 }), expected);
+    EXPECT_EQ(serialize(msg), expected); // unknown peer
+    EXPECT_EQ(serialize(msg, serialize_config{ .peer_version = version_type::HTTPv1_1 }), "HTTP/1.1 200 OK\r\n\r\n");
+}
+
+TEST_F(SerializeMessageTest, ConnectionFieldKeptCaseInsensitive) {
+    message_type msg{
+        .start_line =
+            response_line_type{ .reason = "OK", .status = status_type::OK, .version = version_type::HTTPv1_1 },
+        .framing = { .connection = connection_type::CLOSE },
+    };
+    msg.fields["Connection"] = "close";
+    EXPECT_EQ(serialize(msg), "HTTP/1.1 200 OK\r\nConnection:close\r\n\r\n");
+}
+
+TEST_F(SerializeMessageTest, ConnectionWritten) {
+    for (const auto& [version, connection, expected] : {
+             std::tuple{ version_type::HTTPv1_1, connection_type::CLOSE, "HTTP/1.1 200 OK\r\nconnection:close\r\n\r\n" },
+             std::tuple{
+                 version_type::HTTPv1_0, connection_type::KEEP_ALIVE, "HTTP/1.0 200 OK\r\nconnection:keep-alive\r\n\r\n"
+             },
+             std::tuple{ version_type::HTTPv1_1, connection_type::UPGRADE, "HTTP/1.1 200 OK\r\nconnection:upgrade\r\n\r\n" },
+         }) {
+        message_type msg{
+            .fields = {},
+            .body = {},
+            .start_line = response_line_type{ .reason = "OK", .status = status_type::OK, .version = version },
+            .framing = { .connection = connection },
+        };
+        auto result = serialize(msg);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result.value(), expected);
+    }
+}
+
+TEST_F(SerializeMessageTest, ConnectionFieldKept) {
+    message_type msg{
+        .fields = { { "connection", "Close" } },
+        .body = {},
+        .start_line =
+            response_line_type{ .reason = "OK", .status = status_type::OK, .version = version_type::HTTPv1_1 },
+        .framing = { .connection = connection_type::CLOSE },
+    };
+    auto result = serialize(msg);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), "HTTP/1.1 200 OK\r\nconnection:Close\r\n\r\n");
+}
+
+// larger than the buffer, so both the head and the body take several resumes
+TEST_F(SerializeMessageTest, LargerThanBuffer) {
+    std::string body;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        body += static_cast<char>('a' + i % 26);
+    }
+    const std::string long_value(1500, 'x');
+    const auto body_bytes = detail::buffer_str_to_byte(body);
+    message_type msg{
+        .fields = { { "content-length", "3000" }, { "x-long", long_value } },
+        .body = body_type{ body_bytes.begin(), body_bytes.end() },
+        .start_line =
+            request_line_type{
+                .target = origin_target_type{ .path = "/upload" },
+                .method = method_type::POST,
+                .version = version_type::HTTPv1_1,
+            },
+    };
+
+    const auto serialized = serialize(msg);
+    ASSERT_TRUE(serialized.has_value());
+    const auto reparsed = parse_request(detail::buffer_str_to_byte(serialized.value()));
+    ASSERT_TRUE(reparsed.has_value());
+    EXPECT_EQ(reparsed.value().offset, serialized.value().size());
+    EXPECT_EQ(detail::buffer_byte_to_str(reparsed.value().message.body), body);
+    EXPECT_EQ(reparsed.value().message.fields.at("x-long"), long_value);
+}
+
+TEST_F(SerializeMessageTest, SpilledBodyRoundTrip) {
+    std::string body;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        body += static_cast<char>('a' + i % 26);
+    }
+    const std::string request = "POST /upload HTTP/1.1\r\nContent-Length: 3000\r\n\r\n" + body;
+
+    meta::maybe<message_type> deserialized;
+    auto deserialize = make_deserialize_request(deserialize_config{
+        .message_cb = [&deserialized](message_type message) { deserialized = std::move(message); },
+        .body_spill_size = 16,
+    });
+    ASSERT_FALSE(deserialize(detail::buffer_str_to_byte(request)).has_value());
+    ASSERT_TRUE(deserialized.has_value());
+    ASSERT_TRUE(deserialized.value().body_file.has_value());
+
+    const auto serialized = serialize(deserialized.value());
+    ASSERT_TRUE(serialized.has_value());
+    const auto reparsed = parse_request(detail::buffer_str_to_byte(serialized.value()));
+    ASSERT_TRUE(reparsed.has_value());
+    EXPECT_EQ(reparsed.value().offset, serialized.value().size());
+    EXPECT_EQ(detail::buffer_byte_to_str(reparsed.value().message.body), body);
+}
+
+TEST_F(SerializeMessageTest, SpilledBodyReadFails) {
+    auto file_result = body_file_type::create("/tmp");
+    ASSERT_TRUE(file_result.has_value());
+    auto body_file = std::move(file_result).value();
+    ASSERT_FALSE(body_file.append(detail::buffer_str_to_byte(std::string(3000, 'a'))));
+
+    // the handle now refers to a write-only file, so every read fails
+    const int write_only_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    ASSERT_NE(write_only_fd, -1);
+    ASSERT_NE(::dup2(write_only_fd, body_file.fd()), -1);
+    ::close(write_only_fd);
+
+    const message_type msg{
+        .fields = { { "content-length", "3000" } },
+        .start_line =
+            response_line_type{ .reason = "OK", .status = status_type::OK, .version = version_type::HTTPv1_1 },
+        .body_file = std::move(body_file),
+    };
+    auto serializer = make_serialize(msg, serialize_config{});
+    const auto result = serializer(0);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), std::errc::bad_file_descriptor);
+}
+
 } // namespace sl::http::v1::serialize
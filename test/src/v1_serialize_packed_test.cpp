@@ -0,0 +1,107 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/detail/strings.hpp"
+#include "sl/http/v1/serialize/packed.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sl::http::v1 {
+namespace {
+
+const std::string_view request_head =
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: example.com\r\n"
+    "X-Forwarded-For: 10.0.0.1\r\n"
+    "accept: text/html \r\n"
+    "Cookie: a=b\r\n"
+    "x-forwarded-for: 10.0.0.2\r\n"
+    "\r\n";
+
+packed_message parse_head(std::string_view input) {
+    auto result = parse_packed_request(detail::buffer_str_to_byte(input));
+    EXPECT_TRUE(result.has_value() && result.value().has_value());
+    return std::move(result).value().value().message;
+}
+
+std::string join(const std::vector<std::span<const std::byte>>& pieces) {
+    std::string joined;
+    for (const auto piece : pieces) {
+        joined += detail::buffer_byte_to_str(piece);
+    }
+    return joined;
+}
+
+} // namespace
+
+TEST(SerializePackedTest, UnmodifiedIsRawHead) {
+    const packed_message message = parse_head(request_head);
+    EXPECT_EQ(message.raw_head(), request_head);
+
+    std::vector<std::span<const std::byte>> output;
+    serialize_head(message, head_edits{}, output);
+    ASSERT_EQ(output.size(), 1);
+    EXPECT_EQ(detail::buffer_byte_to_str(output[0]).data(), message.raw_head().data());
+}
+
+TEST(SerializePackedTest, Edits) {
+    const packed_message message = parse_head(request_head);
+    const head_edits edits{
+        .removed = field_names_type{ "cookie" },
+        .replaced = { { "x-forwarded-for", "10.0.0.1, 10.0.0.2, 192.168.0.1" }, { "Via", "1.1 proxy" } },
+        .added = { { "X-Request-Id", "42" } },
+    };
+    std::vector<std::span<const std::byte>> output;
+    serialize_head(message, edits, output);
+    EXPECT_EQ(
+        join(output),
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "X-Forwarded-For: 10.0.0.1, 10.0.0.2, 192.168.0.1\r\n"
+        "accept: text/html \r\n"
+        "Via: 1.1 proxy\r\n"
+        "X-Request-Id: 42\r\n"
+        "\r\n"
+    );
+}
+
+TEST(SerializePackedTest, RoundTrip) {
+    const packed_message message = parse_head(request_head);
+    const head_edits edits{ .added = { { "Forwarded", "for=10.0.0.3" } } };
+    std::vector<std::span<const std::byte>> output;
+    serialize_head(message, edits, output);
+
+    const std::string forwarded = join(output);
+    const packed_message reparsed = parse_head(forwarded);
+    ASSERT_EQ(reparsed.fields().size(), message.fields().size() + 1);
+    for (std::size_t i = 0; i < message.fields().size(); ++i) {
+        EXPECT_EQ(reparsed.view(reparsed.fields()[i].name), message.view(message.fields()[i].name));
+        EXPECT_EQ(reparsed.view(reparsed.fields()[i].value), message.view(message.fields()[i].value));
+    }
+    EXPECT_EQ(reparsed.find_field("forwarded"), std::string_view{ "for=10.0.0.3" });
+}
+
+TEST(SerializePackedTest, TrailersAndBodyNotInHead) {
+    const std::string_view input =
+        "POST / HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "3\r\nabc\r\n"
+        "0\r\n"
+        "X-Checksum: abc\r\n"
+        "\r\n";
+    const packed_message message = parse_head(input);
+    EXPECT_EQ(message.raw_head(), "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+
+    const head_edits edits{ .removed = field_names_type{ "x-checksum" } };
+    std::vector<std::span<const std::byte>> output;
+    serialize_head(message, edits, output);
+    EXPECT_EQ(join(output), message.raw_head());
+}
+
+} // namespace sl::http::v1
@@ -0,0 +1,106 @@
+//
+// Created by usatiynyan.
+//
+
+#include "sl/http/v1/deserialize/target.hpp"
+#include "sl/http/v1/serialize/target.hpp"
+
+#include <gtest/gtest.h>
+
+namespace sl::http::v1 {
+
+TEST(SerializeTarget, Asterisk) { EXPECT_EQ(serialize(asterisk_target_type{}), "*"); }
+
+TEST(SerializeTarget, Authority) {
+    EXPECT_EQ(serialize(authority_target_type{ .host = "example.com", .port = 443 }), "example.com:443");
+}
+
+TEST(SerializeTarget, OriginClean) {
+    const origin_target_type target{
+        .path = "/api/v1/users",
+        .query = { { "page", "1" }, { "sort", "name" } },
+    };
+    EXPECT_EQ(serialize(target), "/api/v1/users?page=1&sort=name");
+}
+
+TEST(SerializeTarget, OriginEscapes) {
+    const origin_target_type target{
+        .path = "/path with spaces/%/\xE2\x9C\x93",
+        .query = { { "q", "hello world" }, { "eq", "a=b&c" } },
+    };
+    EXPECT_EQ(serialize(target), "/path%20with%20spaces/%25/%E2%9C%93?q=hello+world&eq=a%3Db%26c");
+}
+
+TEST(SerializeTarget, UnescapedQuerySize) {
+    const query_params clean{ { "q", "hello" }, { "", "" }, { "page", "1" } };
+    std::string serialized;
+    detail::percent_encode::serialize_query(serialized, clean);
+    EXPECT_EQ(detail::percent_encode::unescaped_query_size(clean), serialized.size());
+    EXPECT_EQ(detail::percent_encode::unescaped_query_size(query_params{}), 0);
+
+    const query_params escaped{ { "eq", "a=b&c" } };
+    EXPECT_EQ(detail::percent_encode::unescaped_query_size(escaped), 9);
+}
+
+TEST(SerializeTarget, OriginPathSubDelimsKept) {
+    const origin_target_type target{ .path = "/a:b@c!$&'()*+,;=" };
+    EXPECT_EQ(serialize(target), "/a:b@c!$&'()*+,;=");
+}
+
+TEST(SerializeTarget, Absolute) {
+    const absolute_target_type target{
+        .scheme = scheme_type::HTTPS,
+        .host = "example.com",
+        .port = 8443,
+        .path = "/a b",
+        .query = { { "k", "v" } },
+    };
+    EXPECT_EQ(serialize(target), "https://example.com:8443/a%20b?k=v");
+}
+
+TEST(SerializeTarget, AbsolutePortOmitted) {
+    EXPECT_EQ(serialize(absolute_target_type{ .host = "example.com", .path = "/" }), "http://example.com/");
+    EXPECT_EQ(
+        serialize(absolute_target_type{ .scheme = scheme_type::HTTPS, .host = "example.com", .path = "/" }),
+        "https://example.com/"
+    );
+}
+
+TEST(SerializeTarget, AbsoluteDefaultPortAndIpLiteral) {
+    const absolute_target_type target{
+        .scheme = scheme_type::HTTP,
+        .userinfo = "user:pass",
+        .host = "::1",
+        .port = 80,
+        .path = "/",
+    };
+    EXPECT_EQ(serialize(target), "http://[::1]/");
+}
+
+TEST(SerializeTarget, Classification) {
+    for (int i = 0; i < 256; ++i) {
+        const char c = static_cast<char>(i);
+        const bool is_alnum = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+        const bool is_unreserved = is_alnum || c == '-' || c == '.' || c == '_' || c == '~';
+        const bool is_path_safe = is_unreserved || std::string_view{ "/:@!$&'()*+,;=" }.find(c) != std::string_view::npos;
+        EXPECT_EQ(detail::percent_encode::is_unreserved(c), is_unreserved) << i;
+        EXPECT_EQ(detail::percent_encode::is_path_safe(c), is_path_safe) << i;
+    }
+}
+
+// Long signed URL survives an encode/decode round trip
+TEST(SerializeTarget, LongRoundTrip) {
+    origin_target_type target{ .path = "/bucket/" + std::string(512, 'k') + "/file name.txt" };
+    target.query.emplace_back("X-Signature", std::string(256, 'a') + "/+=" + std::string(256, 'b'));
+    target.query.emplace_back("X-Expires", "3600");
+
+    const auto serialized = serialize(target);
+    const auto deserialized = deserialize_target(serialized);
+    ASSERT_TRUE(deserialized.has_value());
+    const auto* origin = std::get_if<origin_target_type>(&deserialized.value());
+    ASSERT_NE(origin, nullptr);
+    EXPECT_EQ(origin->path, target.path);
+    EXPECT_EQ(origin->query, target.query);
+}
+
+} // namespace sl::http::v1